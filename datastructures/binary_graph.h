@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../external/status_log.h"
+#include "graph.h"
+#include "mapped_file.h"
+#include "types.h"
+#include "utils.h"
+
+// Binary graph cache layout (native endianness). Every section starts at a
+// multiple of binaryGraphAlignment.
+//
+//   BinaryGraphHeader
+//   adjArray[FWD]  (numVertices + 1) x uint64
+//   toVertex[FWD]  numEdges x uint32
+//   adjArray[BWD]  (numVertices + 1) x uint64     (only if hasReverse)
+//   toVertex[BWD]  numEdges x uint32              (only if hasReverse)
+//   rank           numVertices x uint64           (only if hasRank)
+constexpr char binaryGraphMagic[8] = {'P', 'S', 'L', 'G', 'R', 'A', 'P', 'H'};
+constexpr std::uint32_t binaryGraphVersion = 1;
+constexpr std::size_t binaryGraphAlignment = 64;
+
+struct BinaryGraphHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t headerSize;
+  std::uint64_t numVertices;
+  std::uint64_t numEdges;
+  std::uint8_t hasReverse;
+  std::uint8_t hasRank;
+  std::uint8_t padding[6];
+};
+
+// Byte positions of all sections, derived from the header.
+struct BinaryGraphLayout {
+  std::array<std::size_t, 2> adjArray;
+  std::array<std::size_t, 2> toVertex;
+  std::size_t rank;
+  std::size_t fileSize;
+
+  explicit BinaryGraphLayout(const BinaryGraphHeader& header) {
+    auto align = [](std::size_t pos) {
+      return (pos + binaryGraphAlignment - 1) / binaryGraphAlignment *
+             binaryGraphAlignment;
+    };
+    const std::size_t n = header.numVertices;
+    const std::size_t m = header.numEdges;
+
+    std::size_t pos = align(sizeof(BinaryGraphHeader));
+    for (const DIRECTION dir : {FWD, BWD}) {
+      const bool present = (dir == FWD) || header.hasReverse;
+      adjArray[dir] = pos;
+      if (present) pos = align(pos + (n + 1) * sizeof(std::uint64_t));
+      toVertex[dir] = pos;
+      if (present) pos = align(pos + m * sizeof(Vertex));
+    }
+    rank = pos;
+    if (header.hasRank) pos += n * sizeof(std::uint64_t);
+    fileSize = pos;
+  }
+};
+
+// Writes the (already reordered) forward graph, and optionally its reverse
+// graph and the rank permutation, which was used to reorder it.
+inline void saveGraphToBinaryFile(const Graph& fwdGraph, const Graph* bwdGraph,
+                                  const std::vector<std::size_t>& rank,
+                                  const std::string& fileName) {
+  StatusLog log("Save graph to binary file");
+  std::ofstream outFile(fileName, std::ios::binary);
+
+  if (!outFile.is_open()) {
+    std::cerr << "Error: Unable to open file " << fileName << " for writing.\n";
+    return;
+  }
+
+  assert(!bwdGraph || bwdGraph->numVertices() == fwdGraph.numVertices());
+  assert(!bwdGraph || bwdGraph->numEdges() == fwdGraph.numEdges());
+  assert(rank.empty() || rank.size() == fwdGraph.numVertices());
+
+  BinaryGraphHeader header{};
+  std::memcpy(header.magic, binaryGraphMagic, sizeof(header.magic));
+  header.version = binaryGraphVersion;
+  header.headerSize = sizeof(BinaryGraphHeader);
+  header.numVertices = fwdGraph.numVertices();
+  header.numEdges = fwdGraph.numEdges();
+  header.hasReverse = (bwdGraph != nullptr);
+  header.hasRank = !rank.empty();
+
+  const BinaryGraphLayout layout(header);
+  std::size_t pos = 0;
+
+  auto writeAt = [&](std::size_t target, const void* data, std::size_t bytes) {
+    static const char zeros[binaryGraphAlignment] = {};
+    assert(pos <= target && target - pos < binaryGraphAlignment);
+    outFile.write(zeros, target - pos);
+    outFile.write(reinterpret_cast<const char*>(data), bytes);
+    pos = target + bytes;
+  };
+
+  writeAt(0, &header, sizeof(header));
+  for (const DIRECTION dir : {FWD, BWD}) {
+    const Graph* graph = (dir == FWD) ? &fwdGraph : bwdGraph;
+    if (!graph) continue;
+    writeAt(layout.adjArray[dir], graph->adjArray.data(),
+            graph->adjArray.size() * sizeof(std::uint64_t));
+    writeAt(layout.toVertex[dir], graph->toVertex.data(),
+            graph->toVertex.size() * sizeof(Vertex));
+  }
+  writeAt(layout.rank, rank.data(), rank.size() * sizeof(std::uint64_t));
+  assert(pos == layout.fileSize);
+
+  outFile.close();
+}
+
+// Reads a file written by saveGraphToBinaryFile(). The file is memory-mapped
+// and the arrays are copied in parallel into the graphs, since Graph owns its
+// memory. Returns true if the file contained the reverse graph; otherwise
+// bwdGraph is left untouched. rank is empty if it was not stored.
+inline bool loadGraphFromBinaryFile(const std::string& fileName,
+                                    Graph& fwdGraph, Graph& bwdGraph,
+                                    std::vector<std::size_t>& rank,
+                                    const std::size_t numThreads = 1) {
+  StatusLog log("Reading graph from binary file");
+  MappedFile file(fileName);
+
+  if (file.size() < sizeof(BinaryGraphHeader)) {
+    throw std::runtime_error("Not a binary graph file: " + fileName);
+  }
+
+  BinaryGraphHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+
+  if (std::memcmp(header.magic, binaryGraphMagic, sizeof(header.magic)) != 0) {
+    throw std::runtime_error("Not a binary graph file: " + fileName);
+  }
+  if (header.version != binaryGraphVersion ||
+      header.headerSize != sizeof(BinaryGraphHeader)) {
+    throw std::runtime_error("Unsupported binary graph version in file: " +
+                             fileName);
+  }
+
+  const BinaryGraphLayout layout(header);
+  if (layout.fileSize > file.size()) {
+    throw std::runtime_error("Truncated binary graph file: " + fileName);
+  }
+
+  auto copyArray = [&](auto& target, const std::size_t position,
+                       const std::size_t count) {
+    using T = typename std::remove_reference_t<decltype(target)>::value_type;
+    const T* source = reinterpret_cast<const T*>(file.data() + position);
+    target.resize(count);
+    parallelForBlocks(
+        numThreads, 0, count,
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          std::copy(source + begin, source + end, target.begin() + begin);
+        });
+  };
+
+  const std::size_t n = header.numVertices;
+  const std::size_t m = header.numEdges;
+
+  copyArray(fwdGraph.adjArray, layout.adjArray[FWD], n + 1);
+  copyArray(fwdGraph.toVertex, layout.toVertex[FWD], m);
+
+  if (header.hasReverse) {
+    copyArray(bwdGraph.adjArray, layout.adjArray[BWD], n + 1);
+    copyArray(bwdGraph.toVertex, layout.toVertex[BWD], m);
+  }
+
+  rank.clear();
+  if (header.hasRank) copyArray(rank, layout.rank, n);
+
+  if (fwdGraph.adjArray.back() != m ||
+      (header.hasReverse && bwdGraph.adjArray.back() != m)) {
+    throw std::runtime_error("Corrupted binary graph file: " + fileName);
+  }
+
+  return header.hasReverse;
+}
\ No newline at end of file
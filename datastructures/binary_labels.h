@@ -0,0 +1,329 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../external/status_log.h"
+#include "bit_parallel.h"
+#include "frozen_labels.h"
+#include "intersection.h"
+#include "mapped_file.h"
+#include "types.h"
+
+// Binary label file layout (native endianness). Every section starts at a
+// multiple of binaryLabelAlignment, so that the arrays can be used directly
+// from the mapped memory (also by the SIMD kernels).
+//
+//   BinaryLabelHeader
+//   offsets[FWD]   (numVertices + 1) x uint64
+//   offsets[BWD]   (numVertices + 1) x uint64
+//   hubs[FWD]      numEntries[FWD] x uint32
+//   hubs[BWD]      numEntries[BWD] x uint32
+//   dists[FWD]     numEntries[FWD] x uint8
+//   dists[BWD]     numEntries[BWD] x uint8
+//   f              numOriginalVertices x uint32    (only with PSL+)
+//   oldToNew       numOriginalVertices x uint32    (only with PSL+)
+//   partition      numOriginalVertices x uint8     (only with PSL+)
+//   bpRoots        numBitParallelRoots x uint32    (only with -x)
+//   bpDists[FWD]   numVertices x numBitParallelRoots x uint8
+//   bpDists[BWD]   numVertices x numBitParallelRoots x uint8
+//   bpS_1[FWD]     numVertices x numBitParallelRoots x uint64
+//   bpS_0[FWD]     numVertices x numBitParallelRoots x uint64
+//   bpS_1[BWD]     numVertices x numBitParallelRoots x uint64
+//   bpS_0[BWD]     numVertices x numBitParallelRoots x uint64
+//
+// The labels of a PSL run with bit-parallel roots are pruned against them, so
+// the bit-parallel labels (see BitParallelTable) are part of the file.
+constexpr char binaryLabelMagic[8] = {'P', 'S', 'L', 'L', 'A', 'B', 'E', 'L'};
+constexpr std::uint32_t binaryLabelVersion = 2;
+constexpr std::size_t binaryLabelAlignment = 64;
+
+static_assert(sizeof(std::size_t) == sizeof(std::uint64_t),
+              "Offsets are stored as 64 bit values.");
+
+struct BinaryLabelHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t headerSize;
+  std::uint64_t numVertices;
+  std::array<std::uint64_t, 2> numEntries;
+  std::uint64_t numOriginalVertices;
+  std::uint64_t numBitParallelRoots;
+};
+
+// Byte positions of all sections, derived from the header.
+struct BinaryLabelLayout {
+  std::array<std::size_t, 2> offsets;
+  std::array<std::size_t, 2> hubs;
+  std::array<std::size_t, 2> dists;
+  std::size_t f;
+  std::size_t oldToNew;
+  std::size_t partition;
+  std::size_t bpRoots;
+  std::array<std::size_t, 2> bpDists;
+  std::array<std::array<std::size_t, 2>, 2> bpBitsets;
+  std::size_t fileSize;
+
+  explicit BinaryLabelLayout(const BinaryLabelHeader& header) {
+    auto align = [](std::size_t pos) {
+      return (pos + binaryLabelAlignment - 1) / binaryLabelAlignment *
+             binaryLabelAlignment;
+    };
+    const std::size_t n = header.numVertices;
+    const std::size_t m = header.numOriginalVertices;
+
+    std::size_t pos = align(sizeof(BinaryLabelHeader));
+    for (const DIRECTION dir : {FWD, BWD}) {
+      offsets[dir] = pos;
+      pos = align(pos + (n + 1) * sizeof(std::uint64_t));
+    }
+    for (const DIRECTION dir : {FWD, BWD}) {
+      hubs[dir] = pos;
+      pos = align(pos + header.numEntries[dir] * sizeof(Vertex));
+    }
+    for (const DIRECTION dir : {FWD, BWD}) {
+      dists[dir] = pos;
+      pos = align(pos + header.numEntries[dir] * sizeof(Distance));
+    }
+    f = pos;
+    pos = align(pos + m * sizeof(Vertex));
+    oldToNew = pos;
+    pos = align(pos + m * sizeof(Vertex));
+    partition = pos;
+    pos = align(pos + m * sizeof(std::uint8_t));
+
+    const std::size_t r = header.numBitParallelRoots;
+    bpRoots = pos;
+    pos = align(pos + r * sizeof(Vertex));
+    for (const DIRECTION dir : {FWD, BWD}) {
+      bpDists[dir] = pos;
+      pos = align(pos + n * r * sizeof(Distance));
+    }
+    for (const DIRECTION dir : {FWD, BWD}) {
+      for (const std::size_t s : {1, 0}) {
+        bpBitsets[dir][s] = pos;
+        pos = align(pos + n * r * sizeof(std::uint64_t));
+      }
+    }
+    fileSize = pos;
+  }
+};
+
+inline void saveToBinaryFile(const std::array<FrozenLabels, 2>& labels,
+                             const std::vector<Vertex>& f,
+                             const std::vector<std::uint8_t>& partition,
+                             const std::vector<Vertex>& oldToNew,
+                             const std::string& fileName,
+                             const std::array<BitParallelTable<std::uint64_t>,
+                                              2>& bitParallelLabels = {}) {
+  StatusLog log("Save to binary file");
+  std::ofstream outFile(fileName, std::ios::binary);
+
+  if (!outFile.is_open()) {
+    std::cerr << "Error: Unable to open file " << fileName << " for writing.\n";
+    return;
+  }
+
+  assert(labels[FWD].numVertices() == labels[BWD].numVertices());
+  assert(f.size() == partition.size());
+  assert(f.size() == oldToNew.size());
+  assert(bitParallelLabels[FWD].empty() ||
+         bitParallelLabels[FWD].numVertices() == labels[FWD].numVertices());
+
+  BinaryLabelHeader header{};
+  std::memcpy(header.magic, binaryLabelMagic, sizeof(header.magic));
+  header.version = binaryLabelVersion;
+  header.headerSize = sizeof(BinaryLabelHeader);
+  header.numVertices = labels[FWD].numVertices();
+  header.numEntries = {labels[FWD].numEntries(), labels[BWD].numEntries()};
+  header.numOriginalVertices = f.size();
+  header.numBitParallelRoots = bitParallelLabels[FWD].numRoots();
+
+  const BinaryLabelLayout layout(header);
+  std::size_t pos = 0;
+
+  auto writeAt = [&](std::size_t target, const void* data, std::size_t bytes) {
+    static const char zeros[binaryLabelAlignment] = {};
+    assert(pos <= target && target - pos < binaryLabelAlignment);
+    outFile.write(zeros, target - pos);
+    outFile.write(reinterpret_cast<const char*>(data), bytes);
+    pos = target + bytes;
+  };
+
+  writeAt(0, &header, sizeof(header));
+  for (const DIRECTION dir : {FWD, BWD}) {
+    writeAt(layout.offsets[dir], labels[dir].offsets.data(),
+            labels[dir].offsets.size() * sizeof(std::uint64_t));
+  }
+  for (const DIRECTION dir : {FWD, BWD}) {
+    writeAt(layout.hubs[dir], labels[dir].hubs.data(),
+            labels[dir].hubs.size() * sizeof(Vertex));
+  }
+  for (const DIRECTION dir : {FWD, BWD}) {
+    writeAt(layout.dists[dir], labels[dir].dists.data(),
+            labels[dir].dists.size() * sizeof(Distance));
+  }
+  writeAt(layout.f, f.data(), f.size() * sizeof(Vertex));
+  writeAt(layout.oldToNew, oldToNew.data(), oldToNew.size() * sizeof(Vertex));
+  writeAt(layout.partition, partition.data(),
+          partition.size() * sizeof(std::uint8_t));
+  writeAt(layout.bpRoots, bitParallelLabels[FWD].roots.data(),
+          bitParallelLabels[FWD].roots.size() * sizeof(Vertex));
+  for (const DIRECTION dir : {FWD, BWD}) {
+    writeAt(layout.bpDists[dir], bitParallelLabels[dir].dists.data(),
+            bitParallelLabels[dir].dists.size() * sizeof(Distance));
+  }
+  for (const DIRECTION dir : {FWD, BWD}) {
+    for (const std::size_t s : {1, 0}) {
+      writeAt(layout.bpBitsets[dir][s],
+              bitParallelLabels[dir].bitsets_s[s].data(),
+              bitParallelLabels[dir].bitsets_s[s].size() *
+                  sizeof(std::uint64_t));
+    }
+  }
+  // the last section ends at an aligned position
+  static const char zeros[binaryLabelAlignment] = {};
+  outFile.write(zeros, layout.fileSize - pos);
+
+  outFile.close();
+}
+
+// Non-owning CSR view of the labels of one direction.
+struct LabelArrays {
+  const std::uint64_t* offsets = nullptr;
+  const Vertex* hubs = nullptr;
+  const Distance* dists = nullptr;
+  std::size_t n = 0;
+
+  std::size_t numVertices() const { return n; }
+  std::size_t numEntries() const { return n == 0 ? 0 : offsets[n]; }
+
+  std::size_t size(const Vertex v) const {
+    assert(v < n);
+    return offsets[v + 1] - offsets[v];
+  }
+
+  LabelView operator[](const Vertex v) const {
+    assert(v < n);
+    return LabelView(hubs + offsets[v], dists + offsets[v],
+                     offsets[v + 1] - offsets[v]);
+  }
+};
+
+// Labels memory-mapped from a binary label file. Nothing is parsed or copied;
+// the arrays point directly into the mapping, which lives as long as this
+// object.
+class MappedLabels {
+ public:
+  explicit MappedLabels(const std::string& fileName) : file(fileName) {
+    if (file.size() < sizeof(BinaryLabelHeader)) {
+      throw std::runtime_error("Not a binary label file: " + fileName);
+    }
+    init(fileName);
+  }
+
+  std::size_t numVertices() const { return header().numVertices; }
+  bool hasMapping() const { return header().numOriginalVertices > 0; }
+  bool hasBitParallelLabels() const {
+    return header().numBitParallelRoots > 0;
+  }
+
+  const BinaryLabelHeader& header() const {
+    return *reinterpret_cast<const BinaryLabelHeader*>(file.data());
+  }
+
+  const LabelArrays& operator[](const DIRECTION dir) const {
+    return labels[dir];
+  }
+
+  std::span<const Vertex> f() const { return fSpan; }
+  std::span<const Vertex> oldToNew() const { return oldToNewSpan; }
+  std::span<const std::uint8_t> partition() const { return partitionSpan; }
+  std::span<const Vertex> bitParallelRoots() const { return bpRootsSpan; }
+
+  BitParallelRow<std::uint64_t> bitParallelRow(const DIRECTION dir,
+                                               const Vertex v) const {
+    assert(v < numVertices());
+    const std::size_t r = bpRootsSpan.size();
+    return {bpDists[dir] + v * r, bpBitsets[dir][1] + v * r,
+            bpBitsets[dir][0] + v * r, r};
+  }
+
+ private:
+  void init(const std::string& fileName) {
+    const BinaryLabelHeader& h = header();
+    const char* data = file.data();
+
+    if (std::memcmp(h.magic, binaryLabelMagic, sizeof(h.magic)) != 0) {
+      throw std::runtime_error("Not a binary label file: " + fileName);
+    }
+    if (h.version != binaryLabelVersion ||
+        h.headerSize != sizeof(BinaryLabelHeader)) {
+      throw std::runtime_error("Unsupported binary label version in file: " +
+                               fileName);
+    }
+
+    const BinaryLabelLayout layout(h);
+    if (layout.fileSize > file.size()) {
+      throw std::runtime_error("Truncated binary label file: " + fileName);
+    }
+
+    for (const DIRECTION dir : {FWD, BWD}) {
+      labels[dir].n = h.numVertices;
+      labels[dir].offsets =
+          reinterpret_cast<const std::uint64_t*>(data + layout.offsets[dir]);
+      labels[dir].hubs =
+          reinterpret_cast<const Vertex*>(data + layout.hubs[dir]);
+      labels[dir].dists =
+          reinterpret_cast<const Distance*>(data + layout.dists[dir]);
+
+      if (labels[dir].numEntries() != h.numEntries[dir]) {
+        throw std::runtime_error("Corrupted binary label file: " + fileName);
+      }
+    }
+
+    const std::size_t m = h.numOriginalVertices;
+    fSpan = {reinterpret_cast<const Vertex*>(data + layout.f), m};
+    oldToNewSpan = {reinterpret_cast<const Vertex*>(data + layout.oldToNew), m};
+    partitionSpan = {
+        reinterpret_cast<const std::uint8_t*>(data + layout.partition), m};
+
+    bpRootsSpan = {reinterpret_cast<const Vertex*>(data + layout.bpRoots),
+                   h.numBitParallelRoots};
+    for (const DIRECTION dir : {FWD, BWD}) {
+      bpDists[dir] =
+          reinterpret_cast<const Distance*>(data + layout.bpDists[dir]);
+      for (const std::size_t s : {1, 0}) {
+        bpBitsets[dir][s] = reinterpret_cast<const std::uint64_t*>(
+            data + layout.bpBitsets[dir][s]);
+      }
+    }
+  }
+
+  MappedFile file;
+  std::array<LabelArrays, 2> labels;
+  std::span<const Vertex> fSpan;
+  std::span<const Vertex> oldToNewSpan;
+  std::span<const std::uint8_t> partitionSpan;
+  std::span<const Vertex> bpRootsSpan;
+  std::array<const Distance*, 2> bpDists{};
+  std::array<std::array<const std::uint64_t*, 2>, 2> bpBitsets{};
+};
+
+inline Distance query(const MappedLabels& labels, const Vertex from,
+                      const Vertex to) {
+  if (labels.hasBitParallelLabels()) {
+    return query(labels.bitParallelRow(FWD, from),
+                 labels.bitParallelRow(BWD, to), labels[FWD][from],
+                 labels[BWD][to]);
+  }
+  return query(labels[FWD][from], labels[BWD][to]);
+}
\ No newline at end of file
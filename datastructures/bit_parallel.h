@@ -0,0 +1,320 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../external/status_log.h"
+#include "graph.h"
+#include "hub_labels.h"
+#include "intersection.h"
+#include "thread_pool.h"
+#include "types.h"
+
+// Bit-parallel labels as in PLL: a root r and a set S_r of its neighbours are
+// covered by one bit-parallel entry per vertex, which stores the distance
+// between v and r and, as bitsets over S_r, which s in S_r are one closer to v
+// (S_{-1}) or at the same distance (S_0). A query then finds the shortest path
+// through any vertex of {r} and S_r. The label entries of all these vertices
+// become redundant, so the construction can prune them.
+
+// A root with its selected neighbours.
+struct BitParallelRoot {
+  Vertex root;
+  std::vector<Vertex> neighbours;
+};
+
+// Picks numRoots roots from the highest ranked (lowest id) vertices. Every root
+// takes up to maxNeighbours of its highest ranked neighbours, which must be
+// connected to the root in both directions. No vertex is used twice.
+inline std::vector<BitParallelRoot> selectBitParallelRoots(
+    const std::array<const Graph*, 2>& graphs, const std::size_t numRoots,
+    const std::size_t maxNeighbours) {
+  const std::size_t numVertices = graphs[FWD]->numVertices();
+  std::vector<std::uint8_t> used(numVertices, false);
+  std::vector<std::uint8_t> isInNeighbour(numVertices, false);
+  std::vector<BitParallelRoot> result;
+
+  for (Vertex r = 0; r < numVertices && result.size() < numRoots; ++r) {
+    if (used[r]) continue;
+    used[r] = true;
+
+    graphs[BWD]->relaxAllEdges(
+        r, [&](Vertex /* from */, Vertex v) { isInNeighbour[v] = true; });
+
+    BitParallelRoot root{r, {}};
+    graphs[FWD]->relaxAllEdges(r, [&](Vertex /* from */, Vertex v) {
+      if (!used[v] && isInNeighbour[v]) root.neighbours.push_back(v);
+    });
+    std::sort(root.neighbours.begin(), root.neighbours.end());
+    root.neighbours.erase(
+        std::unique(root.neighbours.begin(), root.neighbours.end()),
+        root.neighbours.end());
+    if (root.neighbours.size() > maxNeighbours) {
+      root.neighbours.resize(maxNeighbours);
+    }
+    for (const Vertex s : root.neighbours) used[s] = true;
+
+    graphs[BWD]->relaxAllEdges(
+        r, [&](Vertex /* from */, Vertex v) { isInNeighbour[v] = false; });
+    result.push_back(std::move(root));
+  }
+  return result;
+}
+
+// The bit-parallel entries of one vertex for all roots, in root order. Roots
+// which the vertex does not reach have distance infinity and empty bitsets.
+template <typename TYPE_BITSET>
+struct BitParallelRow {
+  const Distance* dists = nullptr;
+  const TYPE_BITSET* s_1 = nullptr;
+  const TYPE_BITSET* s_0 = nullptr;
+  std::size_t numRoots = 0;
+};
+
+// Bit-parallel labels of one direction. Every vertex has an entry for every
+// root, so the labels are stored flat as numVertices x numRoots arrays instead
+// of one small label per vertex, and a query needs no merge.
+template <typename TYPE_BITSET>
+struct BitParallelTable {
+  std::vector<Vertex> roots;
+  std::vector<Distance> dists;
+  std::array<std::vector<TYPE_BITSET>, 2> bitsets_s;
+
+  BitParallelTable() = default;
+
+  BitParallelTable(std::vector<Vertex> tableRoots,
+                   const std::size_t numVertices)
+      : roots(std::move(tableRoots)),
+        dists(numVertices * roots.size(), infinity),
+        bitsets_s{std::vector<TYPE_BITSET>(numVertices * roots.size(), 0),
+                  std::vector<TYPE_BITSET>(numVertices * roots.size(), 0)} {}
+
+  bool empty() const { return roots.empty(); }
+  std::size_t numRoots() const { return roots.size(); }
+  std::size_t numVertices() const {
+    return roots.empty() ? 0 : dists.size() / roots.size();
+  }
+
+  BitParallelRow<TYPE_BITSET> operator[](const Vertex v) const {
+    assert(v < numVertices());
+    const std::size_t begin = v * roots.size();
+    return {dists.data() + begin, bitsets_s[1].data() + begin,
+            bitsets_s[0].data() + begin, roots.size()};
+  }
+
+  // Calls apply(root, dist, s_1, s_0) for every root that v reaches.
+  template <typename FUNC>
+  void doForAll(const Vertex v, FUNC&& apply) const {
+    const BitParallelRow<TYPE_BITSET> row = (*this)[v];
+    for (std::size_t i = 0; i < row.numRoots; ++i) {
+      if (row.dists[i] == infinity) continue;
+      apply(roots[i], row.dists[i], row.s_1[i], row.s_0[i]);
+    }
+  }
+
+  std::size_t numEntries() const {
+    return std::count_if(dists.begin(), dists.end(),
+                         [](const Distance d) { return d != infinity; });
+  }
+
+  std::size_t computeTotalBytes() const {
+    return sizeof(BitParallelTable) + roots.capacity() * sizeof(Vertex) +
+           dists.capacity() * sizeof(Distance) +
+           (bitsets_s[0].capacity() + bitsets_s[1].capacity()) *
+               sizeof(TYPE_BITSET);
+  }
+};
+
+// The shortest distance through the roots of two rows of the same roots.
+template <typename TYPE_BITSET>
+Distance bitParallelDistance(const BitParallelRow<TYPE_BITSET>& left,
+                             const BitParallelRow<TYPE_BITSET>& right) {
+  assert(left.numRoots == right.numRoots);
+  std::uint32_t result = infinity;
+  for (std::size_t i = 0; i < left.numRoots; ++i) {
+    // the sum of two distances does not fit into a Distance
+    const std::uint32_t sum =
+        std::uint32_t(left.dists[i]) + std::uint32_t(right.dists[i]);
+    const std::uint32_t correction =
+        (left.s_1[i] & right.s_1[i])
+            ? 2
+            : (((left.s_0[i] & right.s_1[i]) | (left.s_1[i] & right.s_0[i]))
+                   ? 1
+                   : 0);
+    result = std::min(result, sum - correction);
+  }
+  return static_cast<Distance>(result);
+}
+
+template <typename TYPE_BITSET>
+Distance bitParallelDistance(
+    const std::array<BitParallelTable<TYPE_BITSET>, 2>& labels,
+    const Vertex from, const Vertex to) {
+  return bitParallelDistance(labels[FWD][from], labels[BWD][to]);
+}
+
+// Checks the bit-parallel labels first; the normal labels then only have to
+// find a shorter path, so all entries at or above that distance are skipped.
+template <typename TYPE_BITSET>
+Distance query(const BitParallelRow<TYPE_BITSET>& bitParallelLeft,
+               const BitParallelRow<TYPE_BITSET>& bitParallelRight,
+               const LabelView& left, const LabelView& right) {
+  const Distance bound = bitParallelDistance(bitParallelLeft, bitParallelRight);
+  return std::min(bound, sub_query(left, right, bound));
+}
+
+template <typename TYPE_BITSET>
+std::size_t computeTotalBytes(
+    const std::array<BitParallelTable<TYPE_BITSET>, 2>& labels) {
+  return labels[FWD].computeTotalBytes() + labels[BWD].computeTotalBytes();
+}
+
+// Writes the bit-parallel labels in the text format of the BitParallelLabels,
+// see saveToFile() in hub_labels.h.
+template <typename TYPE_BITSET>
+void saveToFile(const std::array<BitParallelTable<TYPE_BITSET>, 2>& labels,
+                const std::string& fileName, const std::size_t numThreads = 1) {
+  StatusLog log("Save to file");
+  std::ofstream outFile(fileName, std::ios::binary);
+
+  if (!outFile.is_open()) {
+    std::cerr << "Error: Unable to open file " << fileName << " for writing.\n";
+    return;
+  }
+
+  const std::size_t N = labels[FWD].numVertices();
+  outFile << "V " << N << "\n";
+  outFile << "W " << (int)(sizeof(TYPE_BITSET) << 3) << "\n";
+
+  auto formatLabel = [](std::string& buffer, const char prefix,
+                        const std::size_t v,
+                        const BitParallelTable<TYPE_BITSET>& table) {
+    buffer += prefix;
+    buffer += ' ';
+    appendNumber(buffer, v);
+    table.doForAll(v, [&buffer](const Vertex hub, const Distance dist,
+                                const TYPE_BITSET s_1, const TYPE_BITSET s_0) {
+      buffer += ' ';
+      appendNumber(buffer, hub);
+      buffer += ' ';
+      appendNumber(buffer, static_cast<int>(dist));
+      buffer += ' ';
+      appendNumber(buffer, s_1);
+      buffer += ' ';
+      appendNumber(buffer, s_0);
+    });
+    buffer += '\n';
+  };
+
+  writeInParallel(outFile, N, numThreads,
+                  [&](const std::size_t v, std::string& buffer) {
+                    formatLabel(buffer, 'o', v, labels[FWD]);
+                    formatLabel(buffer, 'i', v, labels[BWD]);
+                  });
+
+  outFile.close();
+}
+
+// Computes the bit-parallel labels of numRoots roots. labels[FWD][v] holds the
+// distances from v to the roots, labels[BWD][v] the ones from the roots to v.
+// The breadth-first searches of all (root, direction) pairs run in parallel.
+template <typename TYPE_BITSET>
+std::array<BitParallelTable<TYPE_BITSET>, 2> computeBitParallelLabels(
+    const std::array<const Graph*, 2>& graphs, const std::size_t numRoots,
+    ThreadPool& pool) {
+  const std::size_t numVertices = graphs[FWD]->numVertices();
+  const std::vector<BitParallelRoot> roots =
+      selectBitParallelRoots(graphs, numRoots, sizeof(TYPE_BITSET) << 3);
+  if (roots.empty()) return {};
+
+  std::vector<Vertex> rootIds;
+  for (const BitParallelRoot& root : roots) rootIds.push_back(root.root);
+  assert(std::is_sorted(rootIds.begin(), rootIds.end()));
+  std::array<BitParallelTable<TYPE_BITSET>, 2> labels{
+      BitParallelTable<TYPE_BITSET>(rootIds, numVertices),
+      BitParallelTable<TYPE_BITSET>(rootIds, numVertices)};
+
+  // the n-sized arrays of a thread are only allocated with its first search,
+  // since there may be fewer searches than threads
+  struct Search {
+    std::vector<Distance> dist;
+    std::array<std::vector<TYPE_BITSET>, 2> bitsets_s;
+    std::vector<Vertex> queue;
+  };
+  std::vector<Search> searches(pool.size());
+
+  pool.forTasks(2 * roots.size(), [&](std::size_t t, std::size_t task) {
+    const std::size_t rootIndex = task / 2;
+    const BitParallelRoot& root = roots[rootIndex];
+    const DIRECTION dir = static_cast<DIRECTION>(task % 2);
+    // labels[dir][v] is the distance between v and the root in direction
+    // dir, so the search follows the edges of the other direction
+    const Graph& graph = *graphs[!dir];
+    if (searches[t].dist.empty()) {
+      searches[t].dist.assign(numVertices, infinity);
+      searches[t].bitsets_s[1].assign(numVertices, 0);
+      searches[t].bitsets_s[0].assign(numVertices, 0);
+    }
+    std::vector<Distance>& dist = searches[t].dist;
+    std::vector<TYPE_BITSET>& s_1 = searches[t].bitsets_s[1];
+    std::vector<TYPE_BITSET>& s_0 = searches[t].bitsets_s[0];
+    std::vector<Vertex>& queue = searches[t].queue;
+
+    queue.clear();
+    queue.push_back(root.root);
+    dist[root.root] = 0;
+    for (std::size_t i = 0; i < root.neighbours.size(); ++i) {
+      queue.push_back(root.neighbours[i]);
+      dist[root.neighbours[i]] = 1;
+      s_1[root.neighbours[i]] = TYPE_BITSET(1) << i;
+    }
+
+    std::size_t begin = 0;
+    for (Distance d = 0; begin < queue.size(); ++d) {
+      const std::size_t end = (d == 0) ? 1 : queue.size();
+
+      // edges within the level only add to S_0, which must be complete
+      // before the level is passed on to the next one
+      for (std::size_t i = begin; i < end; ++i) {
+        graph.relaxAllEdges(queue[i], [&](Vertex v, Vertex w) {
+          if (dist[w] == d) s_0[w] |= s_1[v];
+        });
+      }
+      // distances of infinity and beyond cannot be stored, so the search
+      // stops after the level infinity - 1
+      for (std::size_t i = begin; d + 1 < infinity && i < end; ++i) {
+        graph.relaxAllEdges(queue[i], [&](Vertex v, Vertex w) {
+          if (dist[w] == infinity) {
+            dist[w] = d + 1;
+            queue.push_back(w);
+          }
+          if (dist[w] == d + 1) {
+            s_1[w] |= s_1[v];
+            s_0[w] |= s_0[v];
+          }
+        });
+      }
+      begin = end;
+    }
+
+    BitParallelTable<TYPE_BITSET>& table = labels[dir];
+    for (const Vertex v : queue) {
+      const std::size_t entry = v * roots.size() + rootIndex;
+      table.dists[entry] = dist[v];
+      table.bitsets_s[1][entry] = s_1[v];
+      table.bitsets_s[0][entry] = s_0[v] & ~s_1[v];
+      dist[v] = infinity;
+      s_1[v] = 0;
+      s_0[v] = 0;
+    }
+  });
+
+  return labels;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "types.h"
+
+// The set of candidate hubs of one vertex during a construction round, which
+// is cleared for every vertex. Every thread needs its own set, so the memory
+// should not grow with numVertices on large graphs:
+//  - TIMESTAMPS marks the vertices in a timestamp array (4 bytes per vertex),
+//    like LookupStorage. This is the fastest mode.
+//  - HASHED keeps the candidates in an open-addressing hash table, which grows
+//    with the number of candidates. Once the table would be larger than a
+//    bitmap over all vertices (numVertices / 8 bytes), the set switches to
+//    such a bitmap until the next clear().
+class CandidateSet {
+ public:
+  enum class Mode { TIMESTAMPS, HASHED };
+
+  // The timestamp arrays of all threads together may use this many bytes.
+  static constexpr std::size_t timestampBudget = std::size_t(1) << 30;
+
+  static Mode chooseMode(const std::size_t numVertices,
+                         const std::size_t numThreads) {
+    return numThreads * numVertices * sizeof(std::uint32_t) <= timestampBudget
+               ? Mode::TIMESTAMPS
+               : Mode::HASHED;
+  }
+
+  CandidateSet(const std::size_t numVertices, const Mode mode)
+      : numVertices(numVertices), mode(mode) {
+    if (mode == Mode::TIMESTAMPS) timestamps.assign(numVertices, 0);
+  }
+
+  // Returns false if v was already contained.
+  bool add(const Vertex v) {
+    assert(v < numVertices);
+    if (mode == Mode::TIMESTAMPS) {
+      if (timestamps[v] == generation) return false;
+      timestamps[v] = generation;
+    } else if (useBitmap) {
+      const std::uint64_t bit = std::uint64_t(1) << (v % 64);
+      if (bitmap[v / 64] & bit) return false;
+      bitmap[v / 64] |= bit;
+    } else {
+      if (!insertIntoTable(v)) return false;
+    }
+    values.push_back(v);
+    return true;
+  }
+
+  const std::vector<Vertex>& getStorage() const { return values; }
+
+  void sort() { std::sort(values.begin(), values.end()); }
+
+  std::size_t size() const { return values.size(); }
+
+  void clear() {
+    if (mode == Mode::TIMESTAMPS) {
+      if (++generation == 0) {
+        std::fill(timestamps.begin(), timestamps.end(), 0);
+        generation = 1;
+      }
+    } else if (useBitmap) {
+      for (const Vertex v : values) bitmap[v / 64] = 0;
+      useBitmap = false;
+    } else {
+      for (const std::size_t slot : usedSlots) table[slot] = noVertex;
+    }
+    usedSlots.clear();
+    values.clear();
+  }
+
+  // Bytes currently held by the set.
+  std::size_t reservedBytes() const {
+    return timestamps.capacity() * sizeof(std::uint32_t) +
+           table.capacity() * sizeof(Vertex) +
+           usedSlots.capacity() * sizeof(std::size_t) +
+           bitmap.capacity() * sizeof(std::uint64_t) +
+           values.capacity() * sizeof(Vertex);
+  }
+
+ private:
+  // Returns false if v is already contained. The table is kept at most half
+  // full and uses linear probing.
+  bool insertIntoTable(const Vertex v) {
+    if (2 * (values.size() + 1) > table.size()) {
+      if (4 * (values.size() + 1) * sizeof(Vertex) > numVertices / 8) {
+        switchToBitmap();
+        const std::uint64_t bit = std::uint64_t(1) << (v % 64);
+        if (bitmap[v / 64] & bit) return false;
+        bitmap[v / 64] |= bit;
+        return true;
+      }
+      growTable();
+    }
+
+    const std::size_t mask = table.size() - 1;
+    for (std::size_t slot = hash(v) & mask;; slot = (slot + 1) & mask) {
+      if (table[slot] == v) return false;
+      if (table[slot] == noVertex) {
+        table[slot] = v;
+        usedSlots.push_back(slot);
+        return true;
+      }
+    }
+  }
+
+  void growTable() {
+    for (const std::size_t slot : usedSlots) table[slot] = noVertex;
+    usedSlots.clear();
+    table.assign(std::max<std::size_t>(16, 2 * table.size()), noVertex);
+
+    const std::size_t mask = table.size() - 1;
+    for (const Vertex v : values) {
+      std::size_t slot = hash(v) & mask;
+      while (table[slot] != noVertex) slot = (slot + 1) & mask;
+      table[slot] = v;
+      usedSlots.push_back(slot);
+    }
+  }
+
+  void switchToBitmap() {
+    if (bitmap.empty()) bitmap.assign(numVertices / 64 + 1, 0);
+    for (const std::size_t slot : usedSlots) table[slot] = noVertex;
+    usedSlots.clear();
+    for (const Vertex v : values) {
+      bitmap[v / 64] |= std::uint64_t(1) << (v % 64);
+    }
+    useBitmap = true;
+  }
+
+  static std::size_t hash(const Vertex v) {
+    return (std::uint64_t(v) * 0x9E3779B97F4A7C15ull) >> 32;
+  }
+
+  std::size_t numVertices;
+  Mode mode;
+
+  std::vector<std::uint32_t> timestamps;
+  std::uint32_t generation = 1;
+
+  std::vector<Vertex> table;
+  std::vector<std::size_t> usedSlots;
+  std::vector<std::uint64_t> bitmap;
+  bool useBitmap = false;
+
+  std::vector<Vertex> values;
+};
\ No newline at end of file
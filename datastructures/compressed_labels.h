@@ -0,0 +1,379 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "../external/status_log.h"
+#include "frozen_labels.h"
+#include "hub_labels.h"
+#include "types.h"
+#include "utils.h"
+
+// Compressed representation of all labels of one direction, to keep large
+// indices in memory. Every label is cut into blocks of blockSize entries. A
+// block stores the distances of its entries (4 bits each if no distance of
+// the labels exceeds 15, otherwise one byte), followed by the gaps between
+// consecutive hubs minus one in the StreamVByte layout: a 2-bit length code
+// per gap, then the 1 to 4 little-endian bytes of every gap. The first hub and
+// the byte offset of every block are kept in a skip table, so a query only
+// decodes the blocks whose hub ranges overlap.
+struct CompressedLabels {
+  static constexpr std::size_t blockSize = 16;
+
+  struct Block {
+    Vertex firstHub;
+    // relative to the first byte of the label
+    std::uint32_t offset;
+  };
+
+  // the blocks of v are blocks[firstBlock[v], firstBlock[v + 1]), its bytes
+  // start at data[dataOffset[v]]
+  std::vector<std::size_t> firstBlock;
+  std::vector<std::size_t> dataOffset;
+  std::vector<std::uint32_t> sizes;
+  std::vector<Block> blocks;
+  std::vector<std::uint8_t> data;
+  std::uint8_t distanceBits;
+
+  CompressedLabels()
+      : firstBlock(1, 0), dataOffset(1, 0), distanceBits(8) {}
+
+  CompressedLabels(const std::vector<Label>& labels,
+                   const std::uint8_t distanceBits,
+                   const std::size_t numThreads = 1)
+      : distanceBits(distanceBits) {
+    assert(distanceBits == 4 || distanceBits == 8);
+    build(labels, numThreads);
+  }
+
+  std::size_t numVertices() const { return sizes.size(); }
+
+  std::size_t size(const Vertex v) const {
+    assert(v < numVertices());
+    return sizes[v];
+  }
+
+  std::size_t numEntries() const {
+    std::size_t result = 0;
+    for (const std::uint32_t size : sizes) result += size;
+    return result;
+  }
+
+  std::size_t computeTotalBytes() const {
+    return sizeof(CompressedLabels) +
+           firstBlock.capacity() * sizeof(std::size_t) +
+           dataOffset.capacity() * sizeof(std::size_t) +
+           sizes.capacity() * sizeof(std::uint32_t) +
+           blocks.capacity() * sizeof(Block) +
+           data.capacity() * sizeof(std::uint8_t);
+  }
+
+  // Decodes the blocks of one label one after another.
+  class Cursor {
+   public:
+    Cursor(const CompressedLabels& labels, const Vertex v)
+        : labels(labels),
+          label(labels.data.data() + labels.dataOffset[v]),
+          block(labels.firstBlock[v]),
+          endBlock(labels.firstBlock[v + 1]),
+          lastSize((labels.sizes[v] + blockSize - 1) % blockSize + 1),
+          decoded(false) {}
+
+    bool done() const { return block == endBlock; }
+
+    Vertex firstHub() const { return labels.blocks[block].firstHub; }
+
+    // all hubs of the current block are below this hub
+    Vertex nextFirstHub() const {
+      return (block + 1 < endBlock) ? labels.blocks[block + 1].firstHub
+                                    : noVertex;
+    }
+
+    void next() {
+      ++block;
+      decoded = false;
+    }
+
+    // The number of entries of the current block, which are decoded into
+    // hubs and dists.
+    std::size_t decode() {
+      const std::size_t size = (block + 1 < endBlock) ? blockSize : lastSize;
+      if (!decoded) {
+        labels.decodeBlock(label + labels.blocks[block].offset, size,
+                           labels.blocks[block].firstHub, hubs, dists);
+        decoded = true;
+      }
+      return size;
+    }
+
+    Vertex hubs[blockSize];
+    Distance dists[blockSize];
+
+   private:
+    const CompressedLabels& labels;
+    const std::uint8_t* label;
+    std::size_t block;
+    std::size_t endBlock;
+    std::size_t lastSize;
+    bool decoded;
+  };
+
+  // Calls apply(hub, dist) for all entries of v, in hub order.
+  template <typename FUNC>
+  void doForAll(const Vertex v, FUNC&& apply) const {
+    for (Cursor cursor(*this, v); !cursor.done(); cursor.next()) {
+      const std::size_t size = cursor.decode();
+      for (std::size_t i = 0; i < size; ++i) {
+        apply(cursor.hubs[i], cursor.dists[i]);
+      }
+    }
+  }
+
+  void decodeBlock(const std::uint8_t* in, const std::size_t size,
+                   const Vertex firstHub, Vertex* hubs,
+                   Distance* dists) const {
+    if (distanceBits == 4) {
+      for (std::size_t i = 0; i < size; ++i) {
+        dists[i] = (in[i / 2] >> (4 * (i & 1))) & 0xF;
+      }
+      in += (size + 1) / 2;
+    } else {
+      std::copy(in, in + size, dists);
+      in += size;
+    }
+
+    const std::uint8_t* control = in;
+    const std::size_t controlBytes = (size + 2) / 4;
+    in += controlBytes;
+    hubs[0] = firstHub;
+
+    // the common case of small gaps only, where every gap is one byte
+    if (std::all_of(control, control + controlBytes,
+                    [](const std::uint8_t c) { return c == 0; })) {
+      for (std::size_t i = 1; i < size; ++i) {
+        hubs[i] = hubs[i - 1] + in[i - 1] + 1;
+      }
+      return;
+    }
+
+    for (std::size_t i = 1; i < size; ++i) {
+      const std::size_t length =
+          ((control[(i - 1) / 4] >> (2 * ((i - 1) % 4))) & 3) + 1;
+      Vertex gap = 0;
+      for (std::size_t b = 0; b < length; ++b) {
+        gap |= static_cast<Vertex>(in[b]) << (8 * b);
+      }
+      in += length;
+      hubs[i] = hubs[i - 1] + gap + 1;
+    }
+  }
+
+ private:
+  static std::size_t gapBytes(const Vertex gap) {
+    return (gap < (1u << 8))    ? 1
+           : (gap < (1u << 16)) ? 2
+           : (gap < (1u << 24)) ? 3
+                                : 4;
+  }
+
+  std::size_t distanceBytes(const std::size_t size) const {
+    return (distanceBits == 4) ? (size + 1) / 2 : size;
+  }
+
+  // Encodes the entries [begin, end) of a label as one block.
+  std::uint8_t* encodeBlock(const std::vector<Vertex>& hubs,
+                            const std::vector<Distance>& dists,
+                            const std::size_t begin, const std::size_t end,
+                            std::uint8_t* out) const {
+    const std::size_t size = end - begin;
+    if (distanceBits == 4) {
+      std::fill(out, out + distanceBytes(size), 0);
+      for (std::size_t i = 0; i < size; ++i) {
+        assert(dists[begin + i] < 16);
+        out[i / 2] |= dists[begin + i] << (4 * (i & 1));
+      }
+    } else {
+      std::copy(dists.begin() + begin, dists.begin() + end, out);
+    }
+    out += distanceBytes(size);
+
+    std::uint8_t* control = out;
+    std::fill(control, control + (size + 2) / 4, 0);
+    out += (size + 2) / 4;
+    for (std::size_t i = 1; i < size; ++i) {
+      assert(hubs[begin + i - 1] < hubs[begin + i]);
+      const Vertex gap = hubs[begin + i] - hubs[begin + i - 1] - 1;
+      const std::size_t length = gapBytes(gap);
+      control[(i - 1) / 4] |= (length - 1) << (2 * ((i - 1) % 4));
+      for (std::size_t b = 0; b < length; ++b) out[b] = gap >> (8 * b);
+      out += length;
+    }
+    return out;
+  }
+
+  std::size_t encodedBytes(const std::vector<Vertex>& hubs,
+                           const std::size_t begin,
+                           const std::size_t end) const {
+    std::size_t bytes = distanceBytes(end - begin) + (end - begin + 2) / 4;
+    for (std::size_t i = begin + 1; i < end; ++i) {
+      bytes += gapBytes(hubs[i] - hubs[i - 1] - 1);
+    }
+    return bytes;
+  }
+
+  // The sizes of all labels are computed first, so every thread can then
+  // encode its labels directly into place.
+  void build(const std::vector<Label>& labels, const std::size_t numThreads) {
+    const std::size_t n = labels.size();
+    sizes.assign(n, 0);
+    firstBlock.assign(n + 1, 0);
+    dataOffset.assign(n + 1, 0);
+
+    parallelForBlocks(numThreads, 0, n,
+                      [&](std::size_t, std::size_t begin, std::size_t end) {
+                        for (std::size_t v = begin; v < end; ++v) {
+                          const std::vector<Vertex>& hubs = labels[v].hubs;
+                          sizes[v] = hubs.size();
+                          firstBlock[v + 1] =
+                              (hubs.size() + blockSize - 1) / blockSize;
+                          for (std::size_t i = 0; i < hubs.size();
+                               i += blockSize) {
+                            dataOffset[v + 1] += encodedBytes(
+                                hubs, i, std::min(i + blockSize, hubs.size()));
+                          }
+                        }
+                      });
+    parallelPrefixSum(firstBlock, numThreads);
+    parallelPrefixSum(dataOffset, numThreads);
+
+    blocks.resize(firstBlock[n]);
+    data.resize(dataOffset[n]);
+
+    parallelForBlocks(
+        numThreads, 0, n,
+        [&](std::size_t, std::size_t begin, std::size_t end) {
+          for (std::size_t v = begin; v < end; ++v) {
+            const std::vector<Vertex>& hubs = labels[v].hubs;
+            const std::vector<Distance>& dists = labels[v].dists;
+            assert(std::is_sorted(hubs.begin(), hubs.end()));
+
+            std::uint8_t* out = data.data() + dataOffset[v];
+            for (std::size_t i = 0; i < hubs.size(); i += blockSize) {
+              const std::size_t blockEnd = std::min(i + blockSize, hubs.size());
+              blocks[firstBlock[v] + i / blockSize] = {
+                  hubs[i], static_cast<std::uint32_t>(
+                               out - (data.data() + dataOffset[v]))};
+              out = encodeBlock(hubs, dists, i, blockEnd, out);
+            }
+            assert(out == data.data() + dataOffset[v + 1]);
+          }
+        });
+  }
+};
+
+// Compresses the labels of both directions, with 4-bit distances if all
+// distances fit.
+inline std::array<CompressedLabels, 2> compress(
+    const std::array<std::vector<Label>, 2>& labels,
+    const std::size_t numThreads = 1) {
+  StatusLog log("Compressing labels");
+  Distance maxDist = 0;
+  for (const auto& labelSet : labels) {
+    for (const Label& label : labelSet) {
+      for (const Distance dist : label.dists) maxDist = std::max(maxDist, dist);
+    }
+  }
+  const std::uint8_t distanceBits = (maxDist < 16) ? 4 : 8;
+  return {CompressedLabels(labels[FWD], distanceBits, numThreads),
+          CompressedLabels(labels[BWD], distanceBits, numThreads)};
+}
+
+// Merges two compressed labels block by block. A block is skipped without
+// decoding if all its hubs are below the first hub of the current block of
+// the other label.
+inline Distance query(const CompressedLabels& fwdLabels, const Vertex from,
+                      const CompressedLabels& bwdLabels, const Vertex to) {
+  CompressedLabels::Cursor left(fwdLabels, from);
+  CompressedLabels::Cursor right(bwdLabels, to);
+  std::uint32_t result = infinity;
+
+  while (!left.done() && !right.done()) {
+    if (left.nextFirstHub() <= right.firstHub()) {
+      left.next();
+      continue;
+    }
+    if (right.nextFirstHub() <= left.firstHub()) {
+      right.next();
+      continue;
+    }
+
+    const std::size_t leftSize = left.decode();
+    const std::size_t rightSize = right.decode();
+    for (std::size_t i = 0, j = 0; i < leftSize && j < rightSize;) {
+      if (left.hubs[i] == right.hubs[j]) {
+        result = std::min<std::uint32_t>(
+            result, static_cast<std::uint32_t>(left.dists[i]) + right.dists[j]);
+        ++i;
+        ++j;
+      } else if (left.hubs[i] < right.hubs[j]) {
+        ++i;
+      } else {
+        ++j;
+      }
+    }
+
+    // the block which ends first cannot meet any later block of the other
+    if (left.nextFirstHub() < right.nextFirstHub()) {
+      left.next();
+    } else {
+      right.next();
+    }
+  }
+  return static_cast<Distance>(std::min<std::uint32_t>(result, infinity));
+}
+
+inline Distance query(const std::array<CompressedLabels, 2>& labels,
+                      const Vertex from, const Vertex to) {
+  return query(labels[FWD], from, labels[BWD], to);
+}
+
+inline void benchmark_hublabels(const std::array<CompressedLabels, 2>& labels,
+                                const std::size_t numQueries) {
+  benchmarkQueries(labels[FWD].numVertices(), numQueries,
+                   [&](const Vertex from, const Vertex to) {
+                     return query(labels, from, to);
+                   });
+}
+
+// Reports the size of the compressed labels next to the frozen (CSR) labels
+// with 4-byte hubs and 1-byte distances.
+inline void showCompressedStats(const std::array<CompressedLabels, 2>& labels) {
+  std::size_t numEntries = 0, numVertices = 0, compressedBytes = 0;
+  for (const CompressedLabels& labelSet : labels) {
+    numEntries += labelSet.numEntries();
+    numVertices += labelSet.numVertices();
+    compressedBytes += labelSet.computeTotalBytes();
+  }
+  const std::size_t frozenBytes =
+      2 * sizeof(FrozenLabels) + (numVertices + 2) * sizeof(std::size_t) +
+      numEntries * (sizeof(Vertex) + sizeof(Distance));
+
+  std::cout << "Compressed labels ("
+            << static_cast<int>(labels[FWD].distanceBits)
+            << "-bit distances):" << std::endl;
+  std::cout << "  Megabytes:    "
+            << static_cast<double>(compressedBytes / (1024.0 * 1024.0))
+            << std::endl;
+  std::cout << "  Bytes/entry:  "
+            << static_cast<double>(compressedBytes) /
+                   std::max<std::size_t>(numEntries, 1)
+            << std::endl;
+  std::cout << "  Ratio vs CSR: "
+            << static_cast<double>(frozenBytes) /
+                   std::max<std::size_t>(compressedBytes, 1)
+            << std::endl;
+}
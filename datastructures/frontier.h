@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "thread_pool.h"
+#include "types.h"
+#include "utils.h"
+
+// How a construction round finds the candidate hubs of a vertex u: in a pull
+// round, every active vertex collects the new hubs of its neighbours; in a
+// push round, every vertex v offers its new hubs to the vertices u which have
+// v as a neighbour. AUTO picks the cheaper one in every round.
+enum class ROUND_MODE { PULL, PUSH, AUTO };
+
+inline ROUND_MODE parseRoundMode(const std::string& name) {
+  if (name == "pull") return ROUND_MODE::PULL;
+  if (name == "push") return ROUND_MODE::PUSH;
+  if (name == "auto") return ROUND_MODE::AUTO;
+  throw std::runtime_error("Unknown round mode: " + name);
+}
+
+// The vertices which have to be processed in the next construction round, per
+// direction. A vertex can only find new hubs if one of its neighbours got new
+// entries in the previous round(s), so the threads activate the neighbours of
+// these vertices and the round only processes the collected vertices.
+class Frontier {
+ public:
+  Frontier(const std::size_t numVertices, const std::size_t numThreads)
+      : isActive{std::vector<std::uint8_t>(numVertices, 0),
+                 std::vector<std::uint8_t>(numVertices, 0)},
+        activated(numThreads) {}
+
+  // Can be called concurrently; every vertex is recorded once.
+  void activate(const std::size_t threadId, const DIRECTION dir,
+                const Vertex v) {
+    if (std::atomic_ref<std::uint8_t>(isActive[dir][v])
+            .exchange(1, std::memory_order_relaxed) == 0) {
+      activated[threadId][dir].push_back(v);
+    }
+  }
+
+  // Replaces the vertices of the last round by the ones activated since then,
+  // sorted by id.
+  void collect(ThreadPool& pool) {
+    for (const DIRECTION dir : {FWD, BWD}) {
+      std::size_t total = 0;
+      for (const auto& local : activated) total += local[dir].size();
+
+      active[dir].resize(total);
+      if (total * denseFraction > isActive[dir].size()) {
+        collectFromFlags(pool, dir);
+      } else {
+        collectFromLists(dir);
+      }
+    }
+    for (auto& local : activated) {
+      local[FWD].clear();
+      local[BWD].clear();
+    }
+  }
+
+  [[nodiscard]] std::span<const Vertex> get(const DIRECTION dir) const {
+    return active[dir];
+  }
+
+  [[nodiscard]] bool empty() const {
+    return active[FWD].empty() && active[BWD].empty();
+  }
+
+ private:
+  // Above numVertices / denseFraction vertices, scanning the flags in parallel
+  // is cheaper than sorting the activation lists.
+  static constexpr std::size_t denseFraction = 32;
+
+  void collectFromLists(const DIRECTION dir) {
+    auto out = active[dir].begin();
+    for (const auto& local : activated) {
+      out = std::copy(local[dir].begin(), local[dir].end(), out);
+    }
+    std::sort(active[dir].begin(), active[dir].end());
+    for (const Vertex v : active[dir]) isActive[dir][v] = 0;
+  }
+
+  void collectFromFlags(ThreadPool& pool, const DIRECTION dir) {
+    std::vector<std::uint8_t>& flags = isActive[dir];
+    std::vector<std::size_t> offset(pool.size() + 1, 0);
+
+    pool.forBlocks(0, flags.size(), [&](std::size_t t, std::size_t begin,
+                                        std::size_t end) {
+      offset[t + 1] = std::count(flags.begin() + begin, flags.begin() + end, 1);
+    });
+    std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+    pool.forBlocks(0, flags.size(), [&](std::size_t t, std::size_t begin,
+                                        std::size_t end) {
+      std::size_t pos = offset[t];
+      for (std::size_t v = begin; v < end; ++v) {
+        if (flags[v] == 0) continue;
+        active[dir][pos++] = static_cast<Vertex>(v);
+        flags[v] = 0;
+      }
+    });
+  }
+
+  std::array<std::vector<std::uint8_t>, 2> isActive;
+  std::vector<std::array<std::vector<Vertex>, 2>> activated;
+  std::array<std::vector<Vertex>, 2> active;
+};
+
+// The candidates of a push round, i.e., pairs (u, w) of a vertex u and a hub w,
+// which the threads add concurrently. collect() groups them by vertex and
+// removes the duplicates, so every vertex gets its sorted candidate hubs.
+class PushedCandidates {
+ public:
+  explicit PushedCandidates(const std::size_t numThreads)
+      : pushed(numThreads) {}
+
+  void add(const std::size_t threadId, const DIRECTION dir, const Vertex u,
+           const Vertex w) {
+    pushed[threadId][dir].emplace_back(u, w);
+  }
+
+  void collect(ThreadPool& pool) {
+    for (const DIRECTION dir : {FWD, BWD}) {
+      std::vector<std::pair<Vertex, Vertex>> pairs;
+      for (auto& local : pushed) {
+        pairs.insert(pairs.end(), local[dir].begin(), local[dir].end());
+        local[dir].clear();
+      }
+      parallelSort(pairs, pool.size(), std::less<>());
+      pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+      hubs[dir].resize(pairs.size());
+      vertices[dir].clear();
+      begins[dir].clear();
+      for (std::size_t i = 0; i < pairs.size(); ++i) {
+        hubs[dir][i] = pairs[i].second;
+        if (i == 0 || pairs[i - 1].first != pairs[i].first) {
+          vertices[dir].push_back(pairs[i].first);
+          begins[dir].push_back(i);
+        }
+      }
+      begins[dir].push_back(pairs.size());
+    }
+  }
+
+  // The number of vertices with candidates.
+  [[nodiscard]] std::size_t size(const DIRECTION dir) const {
+    return vertices[dir].size();
+  }
+
+  [[nodiscard]] Vertex vertex(const DIRECTION dir, const std::size_t i) const {
+    return vertices[dir][i];
+  }
+
+  [[nodiscard]] std::span<const Vertex> candidates(const DIRECTION dir,
+                                                   const std::size_t i) const {
+    return std::span<const Vertex>(hubs[dir]).subspan(
+        begins[dir][i], begins[dir][i + 1] - begins[dir][i]);
+  }
+
+ private:
+  std::vector<std::array<std::vector<std::pair<Vertex, Vertex>>, 2>> pushed;
+  std::array<std::vector<Vertex>, 2> hubs;
+  std::array<std::vector<Vertex>, 2> vertices;
+  std::array<std::vector<std::size_t>, 2> begins;
+};
\ No newline at end of file
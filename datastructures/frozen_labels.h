@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../external/status_log.h"
+#include "bit_parallel.h"
+#include "hub_labels.h"
+#include "intersection.h"
+#include "types.h"
+#include "utils.h"
+
+// Frozen (CSR) representation of all labels of one direction. Built once after
+// the construction is done; the labels of vertex v are stored in
+// hubs[offsets[v], offsets[v + 1]) and dists[offsets[v], offsets[v + 1]).
+// No locks are needed, since the structure is never modified after building.
+struct FrozenLabels {
+  std::vector<std::size_t> offsets;
+  std::vector<Vertex> hubs;
+  std::vector<Distance> dists;
+
+  FrozenLabels() : offsets(1, 0), hubs(), dists() {}
+
+  explicit FrozenLabels(const std::vector<Label>& labels,
+                        const std::size_t numThreads = 1)
+      : offsets(labels.size() + 1, 0) {
+    build(labels, numThreads);
+  }
+
+  std::size_t numVertices() const { return offsets.size() - 1; }
+  std::size_t numEntries() const { return hubs.size(); }
+
+  std::size_t size(const Vertex v) const {
+    assert(v < numVertices());
+    return offsets[v + 1] - offsets[v];
+  }
+
+  LabelView operator[](const Vertex v) const {
+    assert(v < numVertices());
+    return LabelView(hubs.data() + offsets[v], dists.data() + offsets[v],
+                     offsets[v + 1] - offsets[v]);
+  }
+
+  void build(const std::vector<Label>& labels,
+             const std::size_t numThreads = 1) {
+    const std::size_t n = labels.size();
+    offsets.assign(n + 1, 0);
+
+    for (std::size_t v = 0; v < n; ++v) {
+      offsets[v + 1] = offsets[v] + labels[v].size();
+    }
+
+    hubs.resize(offsets[n]);
+    dists.resize(offsets[n]);
+
+    const std::size_t chunkSize = (n + numThreads - 1) / numThreads;
+    std::vector<std::thread> workers;
+
+    for (std::size_t t = 0; t < numThreads; ++t) {
+      workers.emplace_back([&, t]() {
+        const std::size_t start = t * chunkSize;
+        const std::size_t end = std::min(start + chunkSize, n);
+        for (std::size_t v = start; v < end; ++v) {
+          std::size_t i = offsets[v];
+          labels[v].doForAll([&](const Vertex hub, const Distance dist) {
+            hubs[i] = hub;
+            dists[i] = dist;
+            ++i;
+          });
+          assert(i == offsets[v + 1]);
+          assert(std::is_sorted(hubs.begin() + offsets[v],
+                                hubs.begin() + offsets[v + 1]));
+        }
+      });
+    }
+    for (auto& thread : workers) thread.join();
+  }
+
+  std::size_t computeTotalBytes() const {
+    return sizeof(FrozenLabels) + offsets.capacity() * sizeof(std::size_t) +
+           hubs.capacity() * sizeof(Vertex) +
+           dists.capacity() * sizeof(Distance);
+  }
+};
+
+inline std::array<FrozenLabels, 2> freeze(
+    const std::array<std::vector<Label>, 2>& labels,
+    const std::size_t numThreads = 1) {
+  StatusLog log("Freezing labels");
+  return {FrozenLabels(labels[FWD], numThreads),
+          FrozenLabels(labels[BWD], numThreads)};
+}
+
+inline Distance query(const std::array<FrozenLabels, 2>& labels,
+                      const Vertex from, const Vertex to) {
+  return query(labels[FWD][from], labels[BWD][to]);
+}
+
+// Checks the bit-parallel labels of both vertices first, see query() in
+// hub_labels.h.
+template <typename TYPE_BITSET>
+Distance query(
+    const std::array<FrozenLabels, 2>& labels,
+    const std::array<BitParallelTable<TYPE_BITSET>, 2>& bitParallelLabels,
+    const Vertex from, const Vertex to) {
+  return query(bitParallelLabels[FWD][from], bitParallelLabels[BWD][to],
+               labels[FWD][from], labels[BWD][to]);
+}
+
+// Runs the given queries query(from, to) and returns the average time per
+// query in nanoseconds.
+template <typename FUNC>
+double benchmarkQueries(const std::vector<std::pair<Vertex, Vertex>>& queries,
+                        FUNC&& query) {
+  using std::chrono::duration;
+  using std::chrono::high_resolution_clock;
+
+  std::size_t counter = 0;
+  long double totalTime(0);
+  for (std::pair<Vertex, Vertex> paar : queries) {
+    auto t1 = high_resolution_clock::now();
+    auto dist = query(paar.first, paar.second);
+    auto t2 = high_resolution_clock::now();
+    duration<double, std::nano> nano_double = t2 - t1;
+    totalTime += nano_double.count();
+    counter += (dist != infinity);
+  }
+
+  const std::size_t numQueries = queries.size();
+  std::cout << "The " << numQueries << " random queries took in total "
+            << totalTime << " [ns] and on average "
+            << (double)(totalTime / numQueries) << " [ns]! Total of " << counter
+            << " of non-infinty results!\n";
+  return static_cast<double>(totalTime / numQueries);
+}
+
+// Runs numQueries random queries query(from, to) on numVertices vertices and
+// returns the average time per query in nanoseconds.
+template <typename FUNC>
+double benchmarkQueries(const std::size_t numVertices,
+                        const std::size_t numQueries, FUNC&& query) {
+  return benchmarkQueries(
+      generateRandomQueries<Vertex>(numQueries, 0, numVertices),
+      std::forward<FUNC>(query));
+}
+
+inline void benchmark_hublabels(const std::array<FrozenLabels, 2>& labels,
+                                const std::size_t numQueries) {
+  assert(labels[FWD].numVertices() == labels[BWD].numVertices());
+
+  benchmarkQueries(labels[FWD].numVertices(), numQueries,
+                   [&](const Vertex from, const Vertex to) {
+                     return query(labels, from, to);
+                   });
+}
+
+template <typename TYPE_BITSET>
+void benchmark_hublabels(
+    const std::array<FrozenLabels, 2>& labels,
+    const std::array<BitParallelTable<TYPE_BITSET>, 2>& bitParallelLabels,
+    const std::size_t numQueries) {
+  assert(labels[FWD].numVertices() == bitParallelLabels[FWD].numVertices());
+
+  benchmarkQueries(labels[FWD].numVertices(), numQueries,
+                   [&](const Vertex from, const Vertex to) {
+                     return query(labels, bitParallelLabels, from, to);
+                   });
+}
\ No newline at end of file
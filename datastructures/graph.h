@@ -15,11 +15,15 @@
 #include <iostream>
 #include <limits>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <vector>
 
 #include "../external/status_log.h"
+#include "mapped_file.h"
+#include "text_parsing.h"
 #include "types.h"
 #include "utils.h"
 
@@ -46,6 +50,12 @@ struct Graph {
       : adjArray(std::move(other.adjArray)),
         toVertex(std::move(other.toVertex)) {}
 
+  Graph &operator=(Graph &&other) noexcept {
+    adjArray = std::move(other.adjArray);
+    toVertex = std::move(other.toVertex);
+    return *this;
+  }
+
   bool isValid(const Vertex v) const { return v < numVertices(); }
 
   std::size_t numVertices() const { return adjArray.size() - 1; }
@@ -111,173 +121,228 @@ struct Graph {
     toVertex.clear();
   }
 
-  void readFromEdgeList(const std::string &fileName) {
-    StatusLog log("Reading graph from edgelist");
-    clear();
-
-    std::ifstream file(fileName);
-    if (!file.is_open()) {
-      throw std::runtime_error("Cannot open file: " + fileName);
-    }
-
-    std::vector<std::pair<Vertex, Vertex>> edges;
-    Vertex maxVertex = 0;
-
-    std::string line;
-    while (std::getline(file, line)) {
-      std::istringstream iss(line);
-      Vertex u, v;
-      if (!(iss >> u >> v)) {
-        continue;
-      }
-
-      edges.emplace_back(u - 1, v - 1);
-      maxVertex = std::max({maxVertex, u - 1, v - 1});
+  // Builds the CSR arrays from the given edges, which may be spread over
+  // several vectors (e.g. one per parsing thread). Degrees are counted and the
+  // edges scattered in parallel; afterwards every adjacency list is sorted, so
+  // the result does not depend on the number of threads. With
+  // removeDuplicates, parallel edges are removed as well.
+  void buildFromEdges(const std::vector<std::vector<Edge>> &edges,
+                      const std::size_t n, const std::size_t numThreads = 1,
+                      const bool removeDuplicates = false) {
+    adjArray.assign(n + 1, 0);
+    std::atomic<bool> invalidEdge = false;
+
+    parallelForBlocks(
+        numThreads, 0, edges.size(),
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          for (std::size_t i = begin; i < end; ++i) {
+            for (const Edge &e : edges[i]) {
+              if (e.from >= n || e.to >= n) {
+                invalidEdge = true;
+                continue;
+              }
+              std::atomic_ref<std::size_t>(adjArray[e.from + 1])
+                  .fetch_add(1, std::memory_order_relaxed);
+            }
+          }
+        });
+
+    if (invalidEdge) {
+      throw std::runtime_error("Edge with invalid vertex id found.");
+    }
+
+    parallelPrefixSum(adjArray, numThreads);
+
+    toVertex.assign(adjArray.back(), 0);
+    std::vector<std::size_t> offset(adjArray.begin(), adjArray.end() - 1);
+
+    parallelForBlocks(
+        numThreads, 0, edges.size(),
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          for (std::size_t i = begin; i < end; ++i) {
+            for (const Edge &e : edges[i]) {
+              const std::size_t pos =
+                  std::atomic_ref<std::size_t>(offset[e.from])
+                      .fetch_add(1, std::memory_order_relaxed);
+              toVertex[pos] = e.to;
+            }
+          }
+        });
+
+    sortAdjacencyLists(numThreads);
+
+    if (removeDuplicates) {
+      removeEdgesInParallel(
+          numThreads, [&](const Vertex v, const std::size_t i) {
+            return i > beginEdge(v) && toVertex[i] == toVertex[i - 1];
+          });
     }
+  }
 
-    file.close();
-
-    adjArray.resize(maxVertex + 2, 0);
+  void sortAdjacencyLists(const std::size_t numThreads = 1) {
+    parallelForBlocks(
+        numThreads, 0, numVertices(),
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          for (std::size_t v = begin; v < end; ++v) {
+            std::sort(toVertex.begin() + adjArray[v],
+                      toVertex.begin() + adjArray[v + 1]);
+          }
+        });
+  }
 
-    std::sort(edges.begin(), edges.end(),
-              [](const auto &left, const auto &right) {
-                return std::tie(left.first, left.second) <
-                       std::tie(right.first, right.second);
-              });
-    for (const auto &[u, v] : edges) {
-      ++adjArray[u + 1];
-    }
+  // Removes all edges at positions i (of vertex v) with predicate(v, i). The
+  // predicate sees the old arrays.
+  template <typename FUNC>
+  void removeEdgesInParallel(const std::size_t numThreads,
+                             const FUNC &predicate) {
+    const std::size_t n = numVertices();
+    std::vector<std::size_t> newAdjArray(n + 1, 0);
+
+    parallelForBlocks(
+        numThreads, 0, n,
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          for (std::size_t v = begin; v < end; ++v) {
+            for (std::size_t i = beginEdge(v); i < endEdge(v); ++i) {
+              newAdjArray[v + 1] += !predicate(v, i);
+            }
+          }
+        });
+
+    parallelPrefixSum(newAdjArray, numThreads);
+    std::vector<Vertex> newToVertex(newAdjArray.back());
+
+    parallelForBlocks(
+        numThreads, 0, n,
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          for (std::size_t v = begin; v < end; ++v) {
+            std::size_t pos = newAdjArray[v];
+            for (std::size_t i = beginEdge(v); i < endEdge(v); ++i) {
+              if (!predicate(v, i)) newToVertex[pos++] = toVertex[i];
+            }
+          }
+        });
 
-    for (std::size_t i = 1; i < adjArray.size(); ++i) {
-      adjArray[i] += adjArray[i - 1];
-    }
+    adjArray = std::move(newAdjArray);
+    toVertex = std::move(newToVertex);
+  }
 
-    toVertex.resize(edges.size());
-    std::vector<std::size_t> offset = adjArray;
+  // Each line contains two 1-indexed vertex ids; lines which do not start with
+  // two numbers are ignored.
+  void readFromEdgeList(const std::string &fileName,
+                        const std::size_t numThreads = 1) {
+    StatusLog log("Reading graph from edgelist");
+    clear();
 
-    for (const auto &[u, v] : edges) {
-      toVertex[offset[u]++] = v;
-    }
+    MappedFile file(fileName);
+    file.adviseSequential();
+
+    std::vector<std::vector<Edge>> edges(numThreads);
+    std::vector<Vertex> maxVertex(numThreads, 0);
+    std::atomic<bool> malformed = false;
+
+    parseLinesInParallel(
+        file.view(), numThreads,
+        [&](const std::size_t threadId, std::string_view line) {
+          const char *pos = line.data();
+          const char *end = line.data() + line.size();
+          Vertex u, v;
+          if (!parseNext(pos, end, u) || !parseNext(pos, end, v)) return;
+          if (u == 0 || v == 0) {
+            malformed = true;
+            return;
+          }
+
+          edges[threadId].emplace_back(u - 1, v - 1);
+          maxVertex[threadId] = std::max({maxVertex[threadId], u - 1, v - 1});
+        });
+
+    if (malformed) {
+      throw std::runtime_error("Vertex id 0 in 1-indexed edge list: " +
+                               fileName);
+    }
+
+    buildFromEdges(
+        edges, *std::max_element(maxVertex.begin(), maxVertex.end()) + 1,
+        numThreads);
   }
 
-  void readDimacs(const std::string &fileName) {
+  void readDimacs(const std::string &fileName,
+                  const std::size_t numThreads = 1) {
     StatusLog log("Reading graph from dimacs");
     clear();
 
-    std::ifstream file(fileName);
-    if (!file.is_open()) {
-      throw std::runtime_error("Cannot open file: " + fileName);
-    }
+    MappedFile file(fileName);
+    file.adviseSequential();
 
-    std::string line;
-    std::vector<std::pair<Vertex, Vertex>> edges;
-    Vertex numVertices = 0, numEdges = 0;
+    std::vector<std::vector<Edge>> edges(numThreads);
+    std::atomic<std::size_t> announcedVertices = noIndex;
 
-    while (std::getline(file, line)) {
-      if (line.empty() || line[0] == 'c') {
-        continue;
-      }
+    parseLinesInParallel(
+        file.view(), numThreads,
+        [&](const std::size_t threadId, std::string_view line) {
+          const char *pos = line.data() + 1;
+          const char *end = line.data() + line.size();
 
-      if (line[0] == 'p') {
-        std::istringstream iss(line);
-        std::string tmp;
-        if (iss >> tmp >> tmp >> numVertices >> numEdges) {
-          adjArray.assign(numVertices + 1, std::size_t(0));
-          toVertex.assign(numEdges, Vertex(0));
-          edges.reserve(numEdges);
-        }
-      } else if (line[0] == 'a') {
-        std::istringstream iss(line);
-        char a;
-        Vertex u, v;
-        if (iss >> a >> u >> v) {
-          edges.emplace_back(u - 1, v - 1);
-        }
-      }
-    }
+          if (line[0] == 'a') {
+            Vertex u, v;
+            if (parseNext(pos, end, u) && parseNext(pos, end, v) && u > 0 &&
+                v > 0) {
+              edges[threadId].emplace_back(u - 1, v - 1);
+            }
+          } else if (line[0] == 'p') {
+            // skip the problem type, e.g. "sp" or "edge"
+            while (pos < end && *pos == ' ') ++pos;
+            while (pos < end && *pos != ' ') ++pos;
 
-    file.close();
-    std::sort(edges.begin(), edges.end(),
-              [](const auto &left, const auto &right) {
-                return std::tie(left.first, left.second) <
-                       std::tie(right.first, right.second);
-              });
+            std::size_t n;
+            if (parseNext(pos, end, n)) announcedVertices = n;
+          }
+        });
 
-    for (const auto &[u, v] : edges) {
-      ++adjArray[u + 1];
+    if (announcedVertices == noIndex) {
+      throw std::runtime_error("Missing p line in dimacs file: " + fileName);
     }
 
-    for (std::size_t i = 1; i < adjArray.size(); ++i) {
-      adjArray[i] += adjArray[i - 1];
-    }
-
-    adjArray.back() = edges.size();
-
-    toVertex.resize(edges.size());
-    std::vector<std::size_t> offset = adjArray;
-
-    for (const auto &[u, v] : edges) {
-      toVertex[offset[u]++] = v;
-    }
+    buildFromEdges(edges, announcedVertices, numThreads);
   }
 
-  void readSnap(const std::string &fileName) {
+  void readSnap(const std::string &fileName, const std::size_t numThreads = 1) {
     StatusLog log("Reading graph from .snap format");
     clear();
 
-    std::ifstream file(fileName);
-    if (!file.is_open()) {
-      throw std::runtime_error("Cannot open file: " + fileName);
-    }
+    MappedFile file(fileName);
+    file.adviseSequential();
 
-    std::vector<std::pair<Vertex, Vertex>> edges;
-    Vertex maxVertex = 0;
+    std::vector<std::vector<Edge>> edges(numThreads);
+    std::vector<Vertex> maxVertex(numThreads, 0);
+    std::vector<std::string> invalidLines(numThreads);
 
-    std::string line;
-    while (std::getline(file, line)) {
-      if (line.empty() || line[0] == '#') {
-        continue;
-      }
+    parseLinesInParallel(
+        file.view(), numThreads,
+        [&](const std::size_t threadId, std::string_view line) {
+          const char *pos = line.data();
+          const char *end = line.data() + line.size();
+          if (line[0] == '#' || onlyBlanksLeft(pos, end)) return;
 
-      std::istringstream iss(line);
-      Vertex u, v;
-      if (!(iss >> u >> v)) {
-        throw std::runtime_error("Invalid line format in .snap file: " + line);
-      }
+          Vertex u, v;
+          if (!parseNext(pos, end, u) || !parseNext(pos, end, v)) {
+            if (invalidLines[threadId].empty()) invalidLines[threadId] = line;
+            return;
+          }
 
-      edges.emplace_back(u, v);
-      maxVertex = std::max(maxVertex, v);
-    }
+          edges[threadId].emplace_back(u, v);
+          maxVertex[threadId] = std::max({maxVertex[threadId], u, v});
+        });
 
-    file.close();
-
-    adjArray.resize(maxVertex + 2, 0);
-
-    std::sort(edges.begin(), edges.end(),
-              [](const auto &left, const auto &right) {
-                return std::tie(left.first, left.second) <
-                       std::tie(right.first, right.second);
-              });
-
-    auto it = std::unique(edges.begin(), edges.end());
-    edges.erase(it, edges.end());
-
-    for (const auto &[u, v] : edges) {
-      ++adjArray[u + 1];
-    }
-
-    for (std::size_t i = 1; i < adjArray.size(); ++i) {
-      adjArray[i] += adjArray[i - 1];
+    for (const std::string &line : invalidLines) {
+      if (!line.empty()) {
+        throw std::runtime_error("Invalid line format in .snap file: " + line);
+      }
     }
 
-    adjArray.back() = edges.size();
-
-    toVertex.resize(edges.size());
-    std::vector<std::size_t> offset = adjArray;
-
-    for (const auto &[u, v] : edges) {
-      toVertex[offset[u]++] = v;
-    }
+    buildFromEdges(edges,
+                   *std::max_element(maxVertex.begin(), maxVertex.end()) + 1,
+                   numThreads, true);
   }
 
   bool rankIsPermutation(const std::vector<std::size_t> &rank) {
@@ -294,74 +359,86 @@ struct Graph {
     ;
   }
 
-  void reorderByRank(const std::vector<std::size_t> &rank) {
+  // Renames every vertex v to rank[v]. Each vertex copies its own adjacency
+  // list into the new position, so the vertices are processed in parallel.
+  void reorderByRank(const std::vector<std::size_t> &rank,
+                     const std::size_t numThreads = 1) {
     assert(rankIsPermutation(rank));
     assert(rank.size() == numVertices());
 
     std::vector<std::size_t> newAdjArray(numVertices() + 1, 0);
     std::vector<Vertex> newToVertex(numEdges(), 0);
 
-    for (std::size_t v = 0; v < numVertices(); ++v) {
-      newAdjArray[rank[v] + 1] += degree(v);
-    }
-
-    for (std::size_t v = 0; v < numVertices(); ++v) {
-      newAdjArray[v + 1] += newAdjArray[v];
-    }
-
-    std::vector<std::size_t> placedEdges(numVertices(), 0);
-
-    for (std::size_t v = 0; v < numVertices(); ++v) {
-      relaxAllEdges(v, [&](const Vertex /* from */, const Vertex to) {
-        newToVertex[newAdjArray[rank[v]] + placedEdges[rank[v]]] = rank[to];
-        placedEdges[rank[v]]++;
-      });
-    }
-
-    for (std::size_t v = 0; v < numVertices(); ++v) {
-      std::sort(newToVertex.begin() + newAdjArray[v],
-                newToVertex.begin() + newAdjArray[v + 1]);
-    }
+    parallelForBlocks(
+        numThreads, 0, numVertices(),
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          for (std::size_t v = begin; v < end; ++v) {
+            newAdjArray[rank[v] + 1] = degree(v);
+          }
+        });
+
+    parallelPrefixSum(newAdjArray, numThreads);
+
+    parallelForBlocks(
+        numThreads, 0, numVertices(),
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          for (std::size_t v = begin; v < end; ++v) {
+            std::size_t pos = newAdjArray[rank[v]];
+            relaxAllEdges(v, [&](const Vertex /* from */, const Vertex to) {
+              newToVertex[pos++] = rank[to];
+            });
+            std::sort(newToVertex.begin() + newAdjArray[rank[v]],
+                      newToVertex.begin() + pos);
+          }
+        });
 
     adjArray = std::move(newAdjArray);
     toVertex = std::move(newToVertex);
   }
 
-  Graph reverseGraph() const {
+  // Builds the reverse graph directly from this graph, without copying it
+  // first. In-degrees are counted and the edges scattered in parallel; the
+  // sorted adjacency lists make the result independent of numThreads.
+  Graph reverseGraph(const std::size_t numThreads = 1) const {
     StatusLog log("Reversing Graph");
 
     Graph reversed;
-    reversed.adjArray = adjArray;
-    reversed.toVertex = toVertex;
-    reversed.flip();
+    reversed.adjArray.assign(numVertices() + 1, 0);
+
+    parallelForBlocks(
+        numThreads, 0, numVertices(),
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          for (std::size_t i = adjArray[begin]; i < adjArray[end]; ++i) {
+            std::atomic_ref<std::size_t>(reversed.adjArray[toVertex[i] + 1])
+                .fetch_add(1, std::memory_order_relaxed);
+          }
+        });
+
+    parallelPrefixSum(reversed.adjArray, numThreads);
+
+    reversed.toVertex.assign(numEdges(), noVertex);
+    std::vector<std::size_t> offset(reversed.adjArray.begin(),
+                                    reversed.adjArray.end() - 1);
+
+    parallelForBlocks(
+        numThreads, 0, numVertices(),
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          for (Vertex fromV = begin; fromV < end; ++fromV) {
+            for (std::size_t i = beginEdge(fromV); i < endEdge(fromV); ++i) {
+              const std::size_t pos =
+                  std::atomic_ref<std::size_t>(offset[toVertex[i]])
+                      .fetch_add(1, std::memory_order_relaxed);
+              reversed.toVertex[pos] = fromV;
+            }
+          }
+        });
+
+    reversed.sortAdjacencyLists(numThreads);
     return reversed;
   }
 
-  void flip() {
-    std::vector<std::size_t> flippedAdjArray(numVertices() + 1, 0);
-    std::vector<Vertex> flippedToVertex(numEdges(), noVertex);
-
-    for (Vertex fromV(0); fromV < numVertices(); ++fromV) {
-      for (std::size_t i = adjArray[fromV]; i < adjArray[fromV + 1]; ++i) {
-        flippedAdjArray[toVertex[i] + 1]++;
-      }
-    }
-
-    for (Vertex v = 1; v <= numVertices(); ++v) {
-      flippedAdjArray[v] += flippedAdjArray[v - 1];
-    }
-
-    std::vector<std::size_t> offset = flippedAdjArray;
-
-    for (Vertex fromV(0); fromV < numVertices(); ++fromV) {
-      for (std::size_t i = adjArray[fromV]; i < adjArray[fromV + 1]; ++i) {
-        Vertex toV = toVertex[i];
-        flippedToVertex[offset[toV]++] = fromV;
-      }
-    }
-
-    adjArray = std::move(flippedAdjArray);
-    toVertex = std::move(flippedToVertex);
+  void flip(const std::size_t numThreads = 1) {
+    *this = reverseGraph(numThreads);
   }
 
   void showStats() const {
@@ -416,9 +493,12 @@ struct Graph {
     adjArray = std::move(newAdjArray);
   }
 
+  // Keeps the vertices of partition 3 and the representatives of the other
+  // partitions, and renumbers them consecutively in their old order.
   std::vector<Vertex> removeVertices(
       const std::vector<std::uint8_t> &partition,
-      const std::vector<Vertex> &representation) {
+      const std::vector<Vertex> &representation,
+      const std::size_t numThreads = 1) {
     assert(partition.size() == numVertices());
     assert(representation.size() == numVertices());
 
@@ -428,37 +508,59 @@ struct Graph {
 
     const std::size_t oldNumVertices = numVertices();
 
-    std::vector<Vertex> oldToNew(oldNumVertices, static_cast<Vertex>(-1));
-    std::size_t newNumVertices = 0;
-    for (Vertex u = 0; u < oldNumVertices; ++u) {
-      if (keepVertex(u)) oldToNew[u] = newNumVertices++;
-    }
-
+    // inclusive prefix sum over the kept vertices
+    std::vector<Vertex> oldToNew(oldNumVertices, 0);
+    parallelForBlocks(
+        numThreads, 0, oldNumVertices,
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          for (Vertex u = begin; u < end; ++u) oldToNew[u] = keepVertex(u);
+        });
+    parallelPrefixSum(oldToNew, numThreads);
+
+    const std::size_t newNumVertices =
+        oldNumVertices == 0 ? 0 : oldToNew.back();
     std::vector<std::size_t> newAdjArray(newNumVertices + 1, 0);
-    std::size_t newNumEdges = 0;
-
-    for (Vertex u = 0; u < oldNumVertices; ++u) {
-      if (!keepVertex(u)) continue;
-      newAdjArray[oldToNew[u]] = newNumEdges;
-      for (std::size_t j = beginEdge(u); j < endEdge(u); ++j) {
-        Vertex w = toVertex[j];
-        if (keepVertex(w)) ++newNumEdges;
-      }
-    }
-    newAdjArray[newNumVertices] = newNumEdges;
-
-    std::vector<Vertex> newToVertex(newNumEdges, 0);
-    std::size_t edgeIndex = 0;
-    for (Vertex u = 0; u < oldNumVertices; ++u) {
-      if (!keepVertex(u)) continue;
-      for (std::size_t j = beginEdge(u); j < endEdge(u); ++j) {
-        Vertex w = toVertex[j];
-        if (keepVertex(w)) {
-          newToVertex[edgeIndex++] = oldToNew[w];
-        }
-      }
-    }
-    assert(edgeIndex == newNumEdges);
+
+    parallelForBlocks(
+        numThreads, 0, oldNumVertices,
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          for (Vertex u = begin; u < end; ++u) {
+            if (!keepVertex(u)) continue;
+            std::size_t keptEdges = 0;
+            for (std::size_t j = beginEdge(u); j < endEdge(u); ++j) {
+              keptEdges += keepVertex(toVertex[j]);
+            }
+            newAdjArray[oldToNew[u]] = keptEdges;
+          }
+        });
+
+    parallelPrefixSum(newAdjArray, numThreads);
+
+    // turn the prefix sum into the mapping; removed vertices get -1
+    parallelForBlocks(
+        numThreads, 0, oldNumVertices,
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          for (Vertex u = begin; u < end; ++u) {
+            oldToNew[u] = keepVertex(u) ? oldToNew[u] - 1
+                                        : static_cast<Vertex>(-1);
+          }
+        });
+
+    std::vector<Vertex> newToVertex(newAdjArray.back(), 0);
+
+    parallelForBlocks(
+        numThreads, 0, oldNumVertices,
+        [&](std::size_t, const std::size_t begin, const std::size_t end) {
+          for (Vertex u = begin; u < end; ++u) {
+            if (!keepVertex(u)) continue;
+            std::size_t edgeIndex = newAdjArray[oldToNew[u]];
+            for (std::size_t j = beginEdge(u); j < endEdge(u); ++j) {
+              const Vertex w = toVertex[j];
+              if (keepVertex(w)) newToVertex[edgeIndex++] = oldToNew[w];
+            }
+            assert(edgeIndex == newAdjArray[oldToNew[u] + 1]);
+          }
+        });
 
     adjArray = std::move(newAdjArray);
     toVertex = std::move(newToVertex);
@@ -1,16 +1,27 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <bitset>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 #include "../external/status_log.h"
+#include "intersection.h"
+#include "label_sort.h"
+#include "mapped_file.h"
 #include "spin_lock.h"
+#include "text_parsing.h"
+#include "thread_pool.h"
 #include "types.h"
 #include "utils.h"
 
@@ -67,13 +78,7 @@ struct Label {
 
   void sort() {
     std::lock_guard<Spinlock> guard(lock);
-
-    assert(hubs.size() == dists.size());
-    std::vector<std::size_t> p = sort_permutation(
-        hubs, [](Vertex left, Vertex right) { return left < right; });
-
-    apply_permutation_in_place(hubs, p);
-    apply_permutation_in_place(dists, p);
+    sortUnlocked();
   }
 
   void removeDuplicateHubs() {
@@ -96,6 +101,27 @@ struct Label {
     dists.resize(newSize);
   }
 
+  // Removes the given hubs, which have to be sorted and contained.
+  void removeHubs(std::span<const Vertex> sortedHubs) {
+    std::lock_guard<Spinlock> guard(lock);
+
+    std::size_t newSize = 0;
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < hubs.size(); ++i) {
+      if (next < sortedHubs.size() && hubs[i] == sortedHubs[next]) {
+        ++next;
+        continue;
+      }
+      hubs[newSize] = hubs[i];
+      dists[newSize] = dists[i];
+      ++newSize;
+    }
+    assert(next == sortedHubs.size());
+
+    hubs.resize(newSize);
+    dists.resize(newSize);
+  }
+
   void reserve(std::size_t size) {
     std::lock_guard<Spinlock> guard(lock);
 
@@ -126,6 +152,193 @@ struct Label {
     hubs.emplace_back(hub);
     dists.emplace_back(dist);
   }
+
+  // Unlocked view onto the label. It must only be used while nobody modifies
+  // the label, e.g. during a construction round, where all labels are frozen.
+  [[nodiscard]] LabelView view() const {
+    assert(hubs.size() == dists.size());
+    return LabelView(hubs.data(), dists.data(), hubs.size());
+  }
+
+  // Adds all newHubs with the same distance and sorts the label again while
+  // holding the lock, so concurrent queries never see an unsorted label.
+  void addAll(std::span<const Vertex> newHubs, Distance dist) {
+    std::lock_guard<Spinlock> guard(lock);
+
+    assert(hubs.size() == dists.size());
+    const std::size_t sortedPrefix = hubs.size();
+    hubs.insert(hubs.end(), newHubs.begin(), newHubs.end());
+    dists.resize(hubs.size(), dist);
+    threadLocalLabelSorter().sort(hubs.data(), dists.data(), sortedPrefix,
+                                  hubs.size());
+  }
+
+ private:
+  void sortUnlocked() {
+    assert(hubs.size() == dists.size());
+    threadLocalLabelSorter().sort(hubs.data(), dists.data(), 0, hubs.size());
+  }
+};
+
+// The new hubs found by one thread during a construction round. All labels are
+// read-only during a round, so the new hubs are collected here and merged into
+// the labels once the round is finished.
+struct StagedHubs {
+  struct Range {
+    DIRECTION dir;
+    Vertex vertex;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  std::vector<Vertex> hubs;
+  std::vector<Range> ranges;
+
+  void clear() {
+    hubs.clear();
+    ranges.clear();
+  }
+
+  bool empty() const { return ranges.empty(); }
+
+  void add(Vertex hub) { hubs.push_back(hub); }
+
+  // Assigns all hubs added since the last call to the label of vertex in the
+  // given direction.
+  void finish(DIRECTION dir, Vertex vertex) {
+    const std::size_t begin = ranges.empty() ? 0 : ranges.back().end;
+    if (begin < hubs.size()) {
+      ranges.push_back({dir, vertex, begin, hubs.size()});
+    }
+  }
+
+  // Calls apply(dir, vertex, newHubs) for every label with new hubs.
+  template <typename FUNC>
+  void doForAll(FUNC&& apply) const {
+    for (const Range& range : ranges) {
+      apply(range.dir, range.vertex,
+            std::span<const Vertex>(hubs.data() + range.begin,
+                                    range.end - range.begin));
+    }
+  }
+};
+
+// The hubs which were added to every label in the last numLevels rounds, i.e.,
+// the newest distance levels of the labels. A round only needs the entries of
+// one or two specific distances, so it reads them here instead of scanning
+// whole labels. The levels point into the staging buffers of their rounds,
+// which are kept alive until the level is dropped.
+class RecentLevels {
+ public:
+  RecentLevels(const std::size_t numVertices, const std::size_t numThreads,
+               const std::size_t numLevels)
+      : levels(numLevels + 1), newest(0) {
+    for (Level& level : levels) {
+      level.staged.resize(numThreads);
+      level.hubs[FWD].resize(numVertices);
+      level.hubs[BWD].resize(numVertices);
+    }
+  }
+
+  // The hubs added to the label of v age rounds ago (0 is the last round).
+  [[nodiscard]] std::span<const Vertex> get(const std::size_t age,
+                                            const DIRECTION dir,
+                                            const Vertex v) const {
+    assert(age + 1 < levels.size());
+    return levels[(newest + levels.size() - age) % levels.size()].hubs[dir][v];
+  }
+
+  // The per-thread staging buffers of the current round.
+  [[nodiscard]] std::vector<StagedHubs>& next() {
+    return levels[(newest + 1) % levels.size()].staged;
+  }
+
+  // Calls apply(dir, v, hubs) for every label with hubs added age rounds ago,
+  // as far as they were staged by the given thread.
+  template <typename FUNC>
+  void doForAll(const std::size_t age, const std::size_t threadId,
+                FUNC&& apply) const {
+    assert(age + 1 < levels.size());
+    levels[(newest + levels.size() - age) % levels.size()]
+        .staged[threadId]
+        .doForAll(apply);
+  }
+
+  [[nodiscard]] bool nextIsEmpty() const {
+    const auto& staged = levels[(newest + 1) % levels.size()].staged;
+    return std::none_of(staged.begin(), staged.end(),
+                        [](const StagedHubs& hubs) { return !hubs.empty(); });
+  }
+
+  // Makes the hubs staged in next() the newest level and drops the oldest
+  // one, whose buffers are reused for the following round.
+  void advance(ThreadPool& pool) {
+    newest = (newest + 1) % levels.size();
+    Level& level = levels[newest];
+    Level& oldest = levels[(newest + 1) % levels.size()];
+
+    pool.run([&](const std::size_t threadId) {
+      oldest.staged[threadId].doForAll(
+          [&](DIRECTION dir, Vertex v, std::span<const Vertex>) {
+            oldest.hubs[dir][v] = {};
+          });
+      oldest.staged[threadId].clear();
+
+      level.staged[threadId].doForAll(
+          [&](DIRECTION dir, Vertex v, std::span<const Vertex> hubs) {
+            level.hubs[dir][v] = hubs;
+          });
+    });
+  }
+
+ private:
+  struct Level {
+    std::vector<StagedHubs> staged;
+    std::array<std::vector<std::span<const Vertex>>, 2> hubs;
+  };
+
+  std::vector<Level> levels;
+  std::size_t newest;
+};
+
+// One label scattered into a dense distance array indexed by hub. Many labels
+// can then be tested against it by scanning only their own entries, instead of
+// merging both labels for every test. Every thread needs its own instance.
+class ScatteredLabel {
+ public:
+  explicit ScatteredLabel(const std::size_t numVertices)
+      : distance(numVertices, infinity) {}
+
+  void scatter(const LabelView& label) {
+    assert(loaded.size == 0);
+    loaded = label;
+    loaded.doForAll([&](Vertex hub, Distance dist) { distance[hub] = dist; });
+  }
+
+  // Resets the entries of the scattered label, so the array can be reused.
+  void reset() {
+    loaded.doForAll([&](Vertex hub, Distance) { distance[hub] = infinity; });
+    loaded = LabelView();
+  }
+
+  // Returns true if other and the scattered label have a common hub h <= maxHub
+  // with a distance sum of at most bound. The hubs are sorted, so the scan
+  // stops at the first hub above maxHub.
+  [[nodiscard]] bool reaches(const LabelView& other, const Vertex maxHub,
+                             const std::uint32_t bound) const {
+    for (std::size_t i = 0; i < other.size && other.hubs[i] <= maxHub; ++i) {
+      if (static_cast<std::uint32_t>(other.dists[i]) +
+              distance[other.hubs[i]] <=
+          bound) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::vector<Distance> distance;
+  LabelView loaded;
 };
 
 template <typename TYPE_BITSET = std::uint8_t>
@@ -302,50 +515,57 @@ struct BitParallelLabels {
   }
 };
 
-Distance query(const Label& left, const Label& right) {
-  Distance result = infinity;
-  std::size_t i = 0, j = 0;
+// Locks both labels and passes plain views of them to the given function. The
+// locks are always taken in the same (address) order to avoid deadlocks.
+template <typename FUNC>
+auto doWithViews(const Label& left, const Label& right, FUNC&& apply) {
+  if (&left == &right) {
+    std::lock_guard<Spinlock> guard(left.lock);
+    return apply(left.view(), right.view());
+  }
 
-  assert(std::is_sorted(left.hubs.begin(), left.hubs.end()));
-  assert(std::is_sorted(right.hubs.begin(), right.hubs.end()));
+  const Label& first = (&left < &right) ? left : right;
+  const Label& second = (&left < &right) ? right : left;
+  std::lock_guard<Spinlock> guardFirst(first.lock);
+  std::lock_guard<Spinlock> guardSecond(second.lock);
+  return apply(left.view(), right.view());
+}
 
-  while (i < left.size() && j < right.size()) {
-    if (left.getHub(i) == right.getHub(j)) {
-      result = std::min(
-          result, static_cast<Distance>(left.getDist(i) + right.getDist(j)));
-      ++i;
-      ++j;
-    } else if (left.getHub(i) < right.getHub(j)) {
-      ++i;
-    } else {
-      ++j;
-    }
-  }
-  return result;
+inline Distance query(const Label& left, const Label& right) {
+  return doWithViews(left, right,
+                     [](const LabelView& leftView, const LabelView& rightView) {
+                       return query(leftView, rightView);
+                     });
 }
 
+// The shortest distance through the roots of two bit-parallel labels, without
+// locking them; the labels must not be modified concurrently.
 template <typename TYPE_BITSET>
-Distance query(const BitParallelLabels<TYPE_BITSET>& left,
-               const BitParallelLabels<TYPE_BITSET>& right) {
+Distance bitParallelDistance(const BitParallelLabels<TYPE_BITSET>& left,
+                             const BitParallelLabels<TYPE_BITSET>& right) {
   Distance result = infinity;
   std::size_t i = 0, j = 0;
 
   assert(std::is_sorted(left.hubs.begin(), left.hubs.end()));
   assert(std::is_sorted(right.hubs.begin(), right.hubs.end()));
 
-  while (i < left.size() && j < right.size()) {
-    if (left.getHub(i) == right.getHub(j)) {
-      Distance new_distance = left.getDist(i) + right.getDist(j);
-
-      new_distance -= ((left.getBitSetS_1(i) & right.getBitSetS_1(j)) ? 2
-                       : ((left.getBitSetS_0(i) & right.getBitSetS_1(j)) |
-                          (left.getBitSetS_1(i) & right.getBitSetS_0(j)))
-                           ? 1
-                           : 0);
-      result = std::min(result, new_distance);
+  while (i < left.hubs.size() && j < right.hubs.size()) {
+    if (left.hubs[i] == right.hubs[j]) {
+      // the sum of two distances does not fit into a Distance
+      std::uint32_t new_distance = std::uint32_t(left.dists[i]) +
+                                   std::uint32_t(right.dists[j]);
+
+      new_distance -=
+          ((left.bitsets_s[1][i] & right.bitsets_s[1][j]) ? 2
+           : ((left.bitsets_s[0][i] & right.bitsets_s[1][j]) |
+              (left.bitsets_s[1][i] & right.bitsets_s[0][j]))
+               ? 1
+               : 0);
+      result = static_cast<Distance>(
+          std::min<std::uint32_t>(result, new_distance));
       ++i;
       ++j;
-    } else if (left.getHub(i) < right.getHub(j)) {
+    } else if (left.hubs[i] < right.hubs[j]) {
       ++i;
     } else {
       ++j;
@@ -354,37 +574,37 @@ Distance query(const BitParallelLabels<TYPE_BITSET>& left,
   return result;
 }
 
-Distance sub_query(const Label& left, const Label& right, Distance cutoff) {
-  Distance result = infinity;
-  std::size_t i = 0, j = 0;
+template <typename TYPE_BITSET>
+Distance query(const BitParallelLabels<TYPE_BITSET>& left,
+               const BitParallelLabels<TYPE_BITSET>& right) {
+  if (&left == &right) {
+    std::lock_guard<Spinlock> guard(left.lock);
+    return bitParallelDistance(left, right);
+  }
 
-  assert(std::is_sorted(left.hubs.begin(), left.hubs.end()));
-  assert(std::is_sorted(right.hubs.begin(), right.hubs.end()));
+  const auto& first = (&left < &right) ? left : right;
+  const auto& second = (&left < &right) ? right : left;
+  std::lock_guard<Spinlock> guardFirst(first.lock);
+  std::lock_guard<Spinlock> guardSecond(second.lock);
+  return bitParallelDistance(left, right);
+}
 
-  while (i < left.size() && j < right.size()) {
-    if (left.getHub(i) == right.getHub(j)) {
-      if (left.getDist(i) < cutoff && right.getDist(j) < cutoff) {
-        result = std::min(
-            result, static_cast<Distance>(left.getDist(i) + right.getDist(j)));
-      }
-      ++i;
-      ++j;
-    } else if (left.getHub(i) < right.getHub(j)) {
-      ++i;
-    } else {
-      ++j;
-    }
-  }
-  return result;
+inline Distance sub_query(const Label& left, const Label& right,
+                          Distance cutoff) {
+  return doWithViews(
+      left, right, [&](const LabelView& leftView, const LabelView& rightView) {
+        return sub_query(leftView, rightView, cutoff);
+      });
 }
 
-void saveToFile(const std::array<std::vector<Label>, 2>& labels,
-                const std::vector<Vertex>& f,
-                const std::vector<std::uint8_t>& partition,
-                const std::vector<Vertex>& oldToNew,
-                const std::string& fileName) {
+inline void saveToFile(const std::array<std::vector<Label>, 2>& labels,
+                       const std::vector<Vertex>& f,
+                       const std::vector<std::uint8_t>& partition,
+                       const std::vector<Vertex>& oldToNew,
+                       const std::string& fileName,
+                       const std::size_t numThreads = 1) {
   StatusLog log("Save to file");
-  std::ofstream outFile(fileName);
+  std::ofstream outFile(fileName, std::ios::binary);
 
   if (!outFile.is_open()) {
     std::cerr << "Error: Unable to open file " << fileName << " for writing.\n";
@@ -395,26 +615,40 @@ void saveToFile(const std::array<std::vector<Label>, 2>& labels,
 
   outFile << "V " << N << "\n";
 
-  for (std::size_t v = 0; v < N; ++v) {
-    outFile << "o " << v;
-    labels[FWD][v].doForAll([&outFile](const Vertex hub, const Distance dist) {
-      outFile << " " << (int)hub << " " << (int)dist;
+  auto formatLabel = [](std::string& buffer, const char prefix,
+                        const std::size_t v, const Label& label) {
+    buffer += prefix;
+    buffer += ' ';
+    appendNumber(buffer, v);
+    label.doForAll([&buffer](const Vertex hub, const Distance dist) {
+      buffer += ' ';
+      appendNumber(buffer, hub);
+      buffer += ' ';
+      appendNumber(buffer, static_cast<int>(dist));
     });
-    outFile << "\n";
+    buffer += '\n';
+  };
 
-    outFile << "i " << v;
-    labels[BWD][v].doForAll([&outFile](const Vertex hub, const Distance dist) {
-      outFile << " " << (int)hub << " " << (int)dist;
-    });
-    outFile << "\n";
-  }
+  writeInParallel(outFile, N, numThreads,
+                  [&](const std::size_t v, std::string& buffer) {
+                    formatLabel(buffer, 'o', v, labels[FWD][v]);
+                    formatLabel(buffer, 'i', v, labels[BWD][v]);
+                  });
 
   if (!f.empty()) {
     assert(f.size() == partition.size());
-    for (std::size_t i = 0; i < f.size(); ++i) {
-      outFile << "f " << i << " " << (int)partition[i] << " " << f[i] << " "
-              << oldToNew[i] << "\n";
-    }
+    writeInParallel(outFile, f.size(), numThreads,
+                    [&](const std::size_t i, std::string& buffer) {
+                      buffer += "f ";
+                      appendNumber(buffer, i);
+                      buffer += ' ';
+                      appendNumber(buffer, static_cast<int>(partition[i]));
+                      buffer += ' ';
+                      appendNumber(buffer, f[i]);
+                      buffer += ' ';
+                      appendNumber(buffer, oldToNew[i]);
+                      buffer += '\n';
+                    });
   }
 
   outFile.close();
@@ -423,9 +657,9 @@ void saveToFile(const std::array<std::vector<Label>, 2>& labels,
 template <typename TYPE_BITSET>
 void saveToFile(
     const std::array<std::vector<BitParallelLabels<TYPE_BITSET>>, 2>& labels,
-    const std::string& fileName) {
+    const std::string& fileName, const std::size_t numThreads = 1) {
   StatusLog log("Save to file");
-  std::ofstream outFile(fileName);
+  std::ofstream outFile(fileName, std::ios::binary);
 
   if (!outFile.is_open()) {
     std::cerr << "Error: Unable to open file " << fileName << " for writing.\n";
@@ -437,31 +671,194 @@ void saveToFile(
   outFile << "V " << N << "\n";
   outFile << "W " << (int)(sizeof(TYPE_BITSET) << 3) << "\n";
 
-  for (std::size_t v = 0; v < N; ++v) {
-    outFile << "o " << v;
-    labels[FWD][v].doForAll([&outFile](const Vertex hub, const Distance dist,
-                                       const TYPE_BITSET s_1,
-                                       const TYPE_BITSET s_0) {
-      outFile << " " << (int)hub << " " << (int)dist << " " << (int)s_1 << " "
-              << (int)s_0;
-    });
-    outFile << "\n";
-
-    outFile << "i " << v;
-    labels[BWD][v].doForAll([&outFile](const Vertex hub, const Distance dist,
-                                       const TYPE_BITSET s_1,
-                                       const TYPE_BITSET s_0) {
-      outFile << " " << (int)hub << " " << (int)dist << " " << (int)s_1 << " "
-              << (int)s_0;
+  auto formatLabel = [](std::string& buffer, const char prefix,
+                        const std::size_t v,
+                        const BitParallelLabels<TYPE_BITSET>& label) {
+    buffer += prefix;
+    buffer += ' ';
+    appendNumber(buffer, v);
+    label.doForAll([&buffer](const Vertex hub, const Distance dist,
+                             const TYPE_BITSET s_1, const TYPE_BITSET s_0) {
+      buffer += ' ';
+      appendNumber(buffer, hub);
+      buffer += ' ';
+      appendNumber(buffer, static_cast<int>(dist));
+      buffer += ' ';
+      appendNumber(buffer, s_1);
+      buffer += ' ';
+      appendNumber(buffer, s_0);
     });
-    outFile << "\n";
-  }
+    buffer += '\n';
+  };
+
+  writeInParallel(outFile, N, numThreads,
+                  [&](const std::size_t v, std::string& buffer) {
+                    formatLabel(buffer, 'o', v, labels[FWD][v]);
+                    formatLabel(buffer, 'i', v, labels[BWD][v]);
+                  });
 
   outFile.close();
 }
 
-void benchmark_hublabels(std::array<std::vector<Label>, 2>& labels,
-                         const std::size_t numQueries) {
+// One "f" line of a label file, see the README.
+struct FLine {
+  Vertex oldId;
+  std::uint8_t partition;
+  Vertex f;
+  Vertex newId;
+};
+
+// Reads a file written by saveToFile(). The file is memory-mapped, split at
+// line boundaries and parsed by numThreads threads. Each label line is parsed
+// by exactly one thread, so the labels are filled without locking.
+// bitsPerMask is the expected value of the W line, or 0 if there is none.
+// parseEntries(label, pos, end) reads all entries of one label line and
+// returns false if the line is malformed. Returns the parsed f lines.
+template <typename LABEL, typename FUNC>
+std::vector<FLine> loadLabelsFromFile(std::array<std::vector<LABEL>, 2>& labels,
+                                      const std::string& fileName,
+                                      const std::size_t numThreads,
+                                      const std::size_t bitsPerMask,
+                                      FUNC&& parseEntries) {
+  MappedFile file(fileName);
+  file.adviseSequential();
+  std::string_view text = file.view();
+
+  auto nextHeaderLine = [&]() {
+    const std::size_t end = std::min(text.find('\n'), text.size());
+    std::string_view line = text.substr(0, end);
+    text.remove_prefix(std::min(end + 1, text.size()));
+    return line;
+  };
+
+  std::string_view line = nextHeaderLine();
+  const char* pos = line.data() + 1;
+  std::size_t n = 0;
+  if (line.empty() || line[0] != 'V' ||
+      !parseNext(pos, line.data() + line.size(), n)) {
+    throw std::runtime_error("Missing V line in label file: " + fileName);
+  }
+
+  if (!text.empty() && text[0] == 'W') {
+    line = nextHeaderLine();
+    pos = line.data() + 1;
+    std::size_t bits = 0;
+    if (!parseNext(pos, line.data() + line.size(), bits) ||
+        bits != bitsPerMask) {
+      throw std::runtime_error("Unexpected bit-parallel width in file: " +
+                               fileName);
+    }
+  } else if (bitsPerMask != 0) {
+    throw std::runtime_error("Missing W line in label file: " + fileName);
+  }
+
+  labels[FWD] = std::vector<LABEL>(n);
+  labels[BWD] = std::vector<LABEL>(n);
+
+  std::vector<std::vector<FLine>> fLines(numThreads);
+  std::atomic<bool> malformed = false;
+
+  parseLinesInParallel(
+      text, numThreads, [&](const std::size_t threadId, std::string_view line) {
+        const char* pos = line.data() + 1;
+        const char* end = line.data() + line.size();
+
+        if (line[0] == 'o' || line[0] == 'i') {
+          std::size_t v = 0;
+          if (!parseNext(pos, end, v) || v >= n ||
+              !parseEntries(labels[line[0] == 'o' ? FWD : BWD][v], pos, end)) {
+            malformed = true;
+          }
+        } else if (line[0] == 'f') {
+          FLine entry;
+          if (parseNext(pos, end, entry.oldId) &&
+              parseNext(pos, end, entry.partition) &&
+              parseNext(pos, end, entry.f) &&
+              parseNext(pos, end, entry.newId) && onlyBlanksLeft(pos, end)) {
+            fLines[threadId].push_back(entry);
+          } else {
+            malformed = true;
+          }
+        } else if (!onlyBlanksLeft(line.data(), end)) {
+          malformed = true;
+        }
+      });
+
+  if (malformed) {
+    throw std::runtime_error("Malformed line in label file: " + fileName);
+  }
+
+  std::vector<FLine> result;
+  for (const auto& lines : fLines) {
+    result.insert(result.end(), lines.begin(), lines.end());
+  }
+  return result;
+}
+
+inline void loadFromFile(std::array<std::vector<Label>, 2>& labels,
+                         std::vector<Vertex>& f,
+                         std::vector<std::uint8_t>& partition,
+                         std::vector<Vertex>& oldToNew,
+                         const std::string& fileName,
+                         const std::size_t numThreads = 1) {
+  StatusLog log("Load from file");
+
+  const std::vector<FLine> fLines = loadLabelsFromFile(
+      labels, fileName, numThreads, 0,
+      [](Label& label, const char*& pos, const char* end) {
+        Vertex hub;
+        Distance dist;
+        while (parseNext(pos, end, hub)) {
+          if (!parseNext(pos, end, dist)) return false;
+          label.hubs.push_back(hub);
+          label.dists.push_back(dist);
+        }
+        return onlyBlanksLeft(pos, end);
+      });
+
+  f.assign(fLines.size(), 0);
+  partition.assign(fLines.size(), 0);
+  oldToNew.assign(fLines.size(), noVertex);
+
+  for (const FLine& line : fLines) {
+    if (line.oldId >= fLines.size()) {
+      throw std::runtime_error("Invalid f line in label file: " + fileName);
+    }
+    f[line.oldId] = line.f;
+    partition[line.oldId] = line.partition;
+    oldToNew[line.oldId] = line.newId;
+  }
+}
+
+template <typename TYPE_BITSET>
+void loadFromFile(
+    std::array<std::vector<BitParallelLabels<TYPE_BITSET>>, 2>& labels,
+    const std::string& fileName, const std::size_t numThreads = 1) {
+  StatusLog log("Load from file");
+
+  loadLabelsFromFile(
+      labels, fileName, numThreads, sizeof(TYPE_BITSET) << 3,
+      [](BitParallelLabels<TYPE_BITSET>& label, const char*& pos,
+         const char* end) {
+        Vertex hub;
+        Distance dist;
+        TYPE_BITSET s_1, s_0;
+        while (parseNext(pos, end, hub)) {
+          if (!parseNext(pos, end, dist) || !parseNext(pos, end, s_1) ||
+              !parseNext(pos, end, s_0)) {
+            return false;
+          }
+          label.hubs.push_back(hub);
+          label.dists.push_back(dist);
+          label.bitsets_s[1].push_back(s_1);
+          label.bitsets_s[0].push_back(s_0);
+        }
+        return onlyBlanksLeft(pos, end);
+      });
+}
+
+inline void benchmark_hublabels(std::array<std::vector<Label>, 2>& labels,
+                                const std::size_t numQueries) {
   using std::chrono::duration;
   using std::chrono::duration_cast;
   using std::chrono::high_resolution_clock;
@@ -488,7 +885,8 @@ void benchmark_hublabels(std::array<std::vector<Label>, 2>& labels,
             << " of non-infinty results!\n";
 }
 
-std::size_t computeTotalBytes(const std::array<std::vector<Label>, 2>& labels) {
+inline std::size_t computeTotalBytes(
+    const std::array<std::vector<Label>, 2>& labels) {
   std::size_t totalBytes = 0;
 
   for (const auto& labelSet : labels) {
@@ -509,7 +907,7 @@ std::size_t computeTotalBytes(
 
   for (const auto& labelSet : labels) {
     for (const auto& label : labelSet) {
-      totalBytes += sizeof(Label);
+      totalBytes += sizeof(BitParallelLabels<TYPE_BITSET>);
       totalBytes += label.hubs.capacity() * sizeof(Vertex);
       totalBytes += label.dists.capacity() * sizeof(Distance);
       totalBytes += label.bitsets_s[0].capacity() * sizeof(TYPE_BITSET);
@@ -520,7 +918,7 @@ std::size_t computeTotalBytes(
   return totalBytes;
 }
 
-void showLabelStats(const std::array<std::vector<Label>, 2>& labels) {
+inline void showLabelStats(const std::array<std::vector<Label>, 2>& labels) {
   auto computeStats = [](const std::vector<Label>& currentLabels) {
     std::size_t minSize = std::numeric_limits<std::size_t>::max();
     std::size_t maxSize = 0;
@@ -0,0 +1,245 @@
+#pragma once
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+#include "types.h"
+
+// Read-only view onto one label, i.e., the sorted hubs and their distances.
+// It does not own the memory, so it is only valid as long as the underlying
+// storage is alive.
+struct LabelView {
+  const Vertex* hubs;
+  const Distance* dists;
+  std::size_t size;
+
+  LabelView() : hubs(nullptr), dists(nullptr), size(0) {}
+  LabelView(const Vertex* hubs, const Distance* dists, std::size_t size)
+      : hubs(hubs), dists(dists), size(size) {}
+
+  [[nodiscard]] Vertex getHub(std::size_t i) const {
+    assert(i < size);
+    return hubs[i];
+  }
+
+  [[nodiscard]] Distance getDist(std::size_t i) const {
+    assert(i < size);
+    return dists[i];
+  }
+
+  template <typename FUNC>
+  void doForAll(FUNC&& apply) const {
+    for (std::size_t i = 0; i < size; ++i) {
+      apply(hubs[i], dists[i]);
+    }
+  }
+};
+
+// All kernels below compute min(left.dists[i] + right.dists[j]) over all common
+// hubs left.hubs[i] == right.hubs[j], where both distances are smaller than the
+// cutoff. If there is no such pair, infinity is returned.
+constexpr std::uint32_t noCutoff = std::uint32_t(noDistance) + 1;
+
+// If one label is this many times longer than the other, we use galloping.
+constexpr std::size_t gallopingRatio = 32;
+
+// Scalar two-pointer merge, starting at the given positions. This is also used
+// by the SIMD kernels to process the remaining tails.
+inline Distance minDistanceMerge(const LabelView& left, const LabelView& right,
+                                 const std::uint32_t cutoff, std::size_t i = 0,
+                                 std::size_t j = 0,
+                                 std::uint32_t result = infinity) {
+  while (i < left.size && j < right.size) {
+    const Vertex leftHub = left.hubs[i];
+    const Vertex rightHub = right.hubs[j];
+
+    if (leftHub == rightHub) {
+      if (left.dists[i] < cutoff && right.dists[j] < cutoff) {
+        result = std::min(result, static_cast<std::uint32_t>(left.dists[i]) +
+                                      right.dists[j]);
+      }
+      ++i;
+      ++j;
+    } else if (leftHub < rightHub) {
+      ++i;
+    } else {
+      ++j;
+    }
+  }
+  return static_cast<Distance>(result);
+}
+
+// Iterates over the short label and searches each hub in the long label with
+// an exponential search starting at the last found position.
+inline Distance minDistanceGalloping(const LabelView& shortLabel,
+                                     const LabelView& longLabel,
+                                     const std::uint32_t cutoff) {
+  std::uint32_t result = infinity;
+  std::size_t j = 0;
+
+  for (std::size_t i = 0; i < shortLabel.size && j < longLabel.size; ++i) {
+    const Vertex hub = shortLabel.hubs[i];
+
+    std::size_t step = 1;
+    while (j + step < longLabel.size && longLabel.hubs[j + step] < hub) {
+      step <<= 1;
+    }
+
+    const Vertex* begin = longLabel.hubs + j + (step >> 1);
+    const Vertex* end = longLabel.hubs + std::min(j + step + 1, longLabel.size);
+    j = std::lower_bound(begin, end, hub) - longLabel.hubs;
+
+    if (j < longLabel.size && longLabel.hubs[j] == hub &&
+        shortLabel.dists[i] < cutoff && longLabel.dists[j] < cutoff) {
+      result = std::min(result, static_cast<std::uint32_t>(
+                                    shortLabel.dists[i] + longLabel.dists[j]));
+    }
+  }
+  return static_cast<Distance>(result);
+}
+
+#ifdef __AVX2__
+// Compares blocks of 8 hubs against each other by rotating the right block
+// through all 8 lanes. Matching lanes contribute their distance sum to a
+// vector of running minima.
+inline Distance minDistanceAVX2(const LabelView& left, const LabelView& right,
+                                const std::uint32_t cutoff) {
+  constexpr std::size_t width = 8;
+  const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+  const __m256i cutoffVec = _mm256_set1_epi32(static_cast<int>(cutoff));
+  const __m256i tooFar = _mm256_set1_epi32(1 << 16);
+  __m256i best = _mm256_set1_epi32(infinity);
+
+  std::size_t i = 0, j = 0;
+  while (i + width <= left.size && j + width <= right.size) {
+    const __m256i hubsLeft =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left.hubs + i));
+    __m256i hubsRight =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right.hubs + j));
+    __m256i distsLeft = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(left.dists + i)));
+    __m256i distsRight = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(right.dists + j)));
+
+    // distances at or above the cutoff can never improve the result
+    distsLeft = _mm256_blendv_epi8(tooFar, distsLeft,
+                                   _mm256_cmpgt_epi32(cutoffVec, distsLeft));
+    distsRight = _mm256_blendv_epi8(tooFar, distsRight,
+                                    _mm256_cmpgt_epi32(cutoffVec, distsRight));
+
+    for (std::size_t r = 0; r < width; ++r) {
+      const __m256i match = _mm256_cmpeq_epi32(hubsLeft, hubsRight);
+      const __m256i sum = _mm256_add_epi32(distsLeft, distsRight);
+      best = _mm256_min_epu32(best, _mm256_blendv_epi8(best, sum, match));
+      hubsRight = _mm256_permutevar8x32_epi32(hubsRight, rotate);
+      distsRight = _mm256_permutevar8x32_epi32(distsRight, rotate);
+    }
+
+    const Vertex lastLeft = left.hubs[i + width - 1];
+    const Vertex lastRight = right.hubs[j + width - 1];
+    if (lastLeft <= lastRight) i += width;
+    if (lastRight <= lastLeft) j += width;
+  }
+
+  __m128i minimum = _mm_min_epu32(_mm256_castsi256_si128(best),
+                                  _mm256_extracti128_si256(best, 1));
+  minimum = _mm_min_epu32(minimum, _mm_shuffle_epi32(minimum, 0b01001110));
+  minimum = _mm_min_epu32(minimum, _mm_shuffle_epi32(minimum, 0b10110001));
+
+  return minDistanceMerge(
+      left, right, cutoff, i, j,
+      static_cast<std::uint32_t>(_mm_cvtsi128_si32(minimum)));
+}
+#endif
+
+#ifdef __AVX512F__
+// Same as the AVX2 kernel, but with blocks of 16 hubs.
+inline Distance minDistanceAVX512(const LabelView& left,
+                                  const LabelView& right,
+                                  const std::uint32_t cutoff) {
+  constexpr std::size_t width = 16;
+  const __m512i rotate = _mm512_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                           12, 13, 14, 15, 0);
+  const __m512i cutoffVec = _mm512_set1_epi32(static_cast<int>(cutoff));
+  const __m512i tooFar = _mm512_set1_epi32(1 << 16);
+  __m512i best = _mm512_set1_epi32(infinity);
+
+  std::size_t i = 0, j = 0;
+  while (i + width <= left.size && j + width <= right.size) {
+    const __m512i hubsLeft = _mm512_loadu_si512(left.hubs + i);
+    __m512i hubsRight = _mm512_loadu_si512(right.hubs + j);
+    __m512i distsLeft = _mm512_cvtepu8_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(left.dists + i)));
+    __m512i distsRight = _mm512_cvtepu8_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(right.dists + j)));
+
+    // distances at or above the cutoff can never improve the result
+    distsLeft = _mm512_mask_blend_epi32(
+        _mm512_cmplt_epu32_mask(distsLeft, cutoffVec), tooFar, distsLeft);
+    distsRight = _mm512_mask_blend_epi32(
+        _mm512_cmplt_epu32_mask(distsRight, cutoffVec), tooFar, distsRight);
+
+    for (std::size_t r = 0; r < width; ++r) {
+      const __mmask16 match = _mm512_cmpeq_epi32_mask(hubsLeft, hubsRight);
+      best = _mm512_mask_min_epu32(best, match, best,
+                                   _mm512_add_epi32(distsLeft, distsRight));
+      hubsRight = _mm512_permutexvar_epi32(rotate, hubsRight);
+      distsRight = _mm512_permutexvar_epi32(rotate, distsRight);
+    }
+
+    const Vertex lastLeft = left.hubs[i + width - 1];
+    const Vertex lastRight = right.hubs[j + width - 1];
+    if (lastLeft <= lastRight) i += width;
+    if (lastRight <= lastLeft) j += width;
+  }
+
+  return minDistanceMerge(
+      left, right, cutoff, i, j,
+      static_cast<std::uint32_t>(_mm512_reduce_min_epu32(best)));
+}
+#endif
+
+// Picks the kernel from the label lengths: galloping if one label is much
+// shorter than the other, the widest available SIMD kernel if both labels
+// fill at least one block, and the scalar merge otherwise.
+inline Distance minDistance(const LabelView& left, const LabelView& right,
+                            const std::uint32_t cutoff = noCutoff) {
+  const LabelView& shorter = (left.size <= right.size) ? left : right;
+  const LabelView& longer = (left.size <= right.size) ? right : left;
+
+  if (shorter.size == 0) return infinity;
+
+  if (shorter.size * gallopingRatio < longer.size) {
+    return minDistanceGalloping(shorter, longer, cutoff);
+  }
+
+#if defined(__AVX512F__)
+  if (shorter.size >= 16) return minDistanceAVX512(left, right, cutoff);
+#endif
+#if defined(__AVX2__)
+  if (shorter.size >= 8) return minDistanceAVX2(left, right, cutoff);
+#endif
+
+  return minDistanceMerge(left, right, cutoff);
+}
+
+inline Distance query(const LabelView& left, const LabelView& right) {
+  assert(std::is_sorted(left.hubs, left.hubs + left.size));
+  assert(std::is_sorted(right.hubs, right.hubs + right.size));
+
+  return minDistance(left, right);
+}
+
+inline Distance sub_query(const LabelView& left, const LabelView& right,
+                          Distance cutoff) {
+  assert(std::is_sorted(left.hubs, left.hubs + left.size));
+  assert(std::is_sorted(right.hubs, right.hubs + right.size));
+
+  return minDistance(left, right, cutoff);
+}
\ No newline at end of file
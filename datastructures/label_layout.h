@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../external/status_log.h"
+#include "frozen_labels.h"
+#include "graph.h"
+#include "hub_labels.h"
+#include "types.h"
+#include "utils.h"
+
+// Breadth-first order over the edges of both directions. Every component is
+// started at its highest ranked (smallest) vertex, so vertices which are close
+// in the graph end up close in the order.
+inline std::vector<Vertex> bfsOrder(const Graph& fwdGraph,
+                                    const Graph& bwdGraph) {
+  const std::size_t n = fwdGraph.numVertices();
+  assert(bwdGraph.numVertices() == n);
+
+  std::vector<Vertex> order;
+  order.reserve(n);
+  std::vector<bool> seen(n, false);
+  for (Vertex root = 0; root < n; ++root) {
+    if (seen[root]) continue;
+    seen[root] = true;
+    order.push_back(root);
+    for (std::size_t i = order.size() - 1; i < order.size(); ++i) {
+      const Vertex u = order[i];
+      for (const Graph* graph : {&fwdGraph, &bwdGraph}) {
+        graph->relaxAllEdges(u, [&](const Vertex, const Vertex w) {
+          if (seen[w]) return;
+          seen[w] = true;
+          order.push_back(w);
+        });
+      }
+    }
+  }
+  return order;
+}
+
+// Frozen labels whose storage follows a locality order instead of the vertex
+// ids. The label of vertex v is found at slot position[v], and order[slot]
+// maps back to the vertex, so callers keep using the original ids. Only the
+// placement of the labels changes: the hubs keep their ids (the ranks), so
+// every label stays sorted for the merge.
+struct LaidOutLabels {
+  std::vector<Vertex> order;
+  std::vector<Vertex> position;
+  std::array<FrozenLabels, 2> labels;
+
+  LaidOutLabels() = default;
+
+  LaidOutLabels(const std::array<FrozenLabels, 2>& frozen,
+                std::vector<Vertex> layoutOrder,
+                const std::size_t numThreads = 1)
+      : order(std::move(layoutOrder)) {
+    build(frozen, numThreads);
+  }
+
+  std::size_t numVertices() const { return order.size(); }
+
+  LabelView operator()(const DIRECTION dir, const Vertex v) const {
+    assert(v < numVertices());
+    return labels[dir][position[v]];
+  }
+
+  std::size_t computeTotalBytes() const {
+    return sizeof(LaidOutLabels) + order.capacity() * sizeof(Vertex) +
+           position.capacity() * sizeof(Vertex) +
+           labels[FWD].computeTotalBytes() + labels[BWD].computeTotalBytes();
+  }
+
+  void build(const std::array<FrozenLabels, 2>& frozen,
+             const std::size_t numThreads = 1) {
+    const std::size_t n = order.size();
+    assert(frozen[FWD].numVertices() == n);
+
+    position.assign(n, noVertex);
+    for (std::size_t slot = 0; slot < n; ++slot) position[order[slot]] = slot;
+    assert(std::find(position.begin(), position.end(), noVertex) ==
+           position.end());
+
+    for (const DIRECTION dir : {FWD, BWD}) {
+      const FrozenLabels& source = frozen[dir];
+      FrozenLabels& target = labels[dir];
+      target.offsets.assign(n + 1, 0);
+      for (std::size_t slot = 0; slot < n; ++slot) {
+        target.offsets[slot + 1] = source.size(order[slot]);
+      }
+      parallelPrefixSum(target.offsets, numThreads);
+
+      target.hubs.resize(target.offsets[n]);
+      target.dists.resize(target.offsets[n]);
+      parallelForBlocks(
+          numThreads, 0, n,
+          [&](std::size_t, std::size_t begin, std::size_t end) {
+            for (std::size_t slot = begin; slot < end; ++slot) {
+              const LabelView label = source[order[slot]];
+              std::copy(label.hubs, label.hubs + label.size,
+                        target.hubs.begin() + target.offsets[slot]);
+              std::copy(label.dists, label.dists + label.size,
+                        target.dists.begin() + target.offsets[slot]);
+            }
+          });
+    }
+  }
+};
+
+inline LaidOutLabels layOutInBFSOrder(const std::array<FrozenLabels, 2>& frozen,
+                                      const Graph& fwdGraph,
+                                      const Graph& bwdGraph,
+                                      const std::size_t numThreads = 1) {
+  StatusLog log("Laying out labels in BFS order");
+  return LaidOutLabels(frozen, bfsOrder(fwdGraph, bwdGraph), numThreads);
+}
+
+inline Distance query(const LaidOutLabels& labels, const Vertex from,
+                      const Vertex to) {
+  return query(labels(FWD, from), labels(BWD, to));
+}
+
+// Queries between two random walks over both edge directions, i.e. every
+// query is close in the graph to the one before it. This is the workload
+// where the placement of the labels matters.
+inline std::vector<std::pair<Vertex, Vertex>> generateRandomWalkQueries(
+    const Graph& fwdGraph, const Graph& bwdGraph,
+    const std::size_t numQueries) {
+  const std::size_t n = fwdGraph.numVertices();
+  std::vector<std::pair<Vertex, Vertex>> queries;
+  if (n == 0) return queries;
+  queries.reserve(numQueries);
+  std::mt19937 randomGenerator(42);
+
+  auto step = [&](const Vertex v) -> Vertex {
+    const std::size_t degree = fwdGraph.degree(v) + bwdGraph.degree(v);
+    // restart now and then, and in vertices without edges
+    if (degree == 0 || randomGenerator() % 32 == 0) {
+      return randomGenerator() % n;
+    }
+    const std::size_t i = randomGenerator() % degree;
+    return i < fwdGraph.degree(v)
+               ? fwdGraph.toVertex[fwdGraph.beginEdge(v) + i]
+               : bwdGraph.toVertex[bwdGraph.beginEdge(v) + i -
+                                   fwdGraph.degree(v)];
+  };
+
+  Vertex from = randomGenerator() % n;
+  Vertex to = randomGenerator() % n;
+  for (std::size_t i = 0; i < numQueries; ++i) {
+    queries.emplace_back(from, to);
+    from = step(from);
+    to = step(to);
+  }
+  return queries;
+}
+
+// Compares the query times on the labels in vertex order and in the locality
+// order, on random pairs and on random walk pairs.
+inline void benchmarkLayout(const std::array<FrozenLabels, 2>& frozen,
+                            const LaidOutLabels& laidOut,
+                            const Graph& fwdGraph, const Graph& bwdGraph,
+                            const std::size_t numQueries) {
+  using Queries = std::vector<std::pair<Vertex, Vertex>>;
+  const std::array<std::pair<const char*, Queries>, 2> workloads{
+      {{"random pairs", generateRandomQueries<Vertex>(
+                            numQueries, 0, frozen[FWD].numVertices())},
+       {"random walk pairs",
+        generateRandomWalkQueries(fwdGraph, bwdGraph, numQueries)}}};
+
+  for (const auto& [name, queries] : workloads) {
+    std::cout << "Layout benchmark on " << name << ":" << std::endl;
+    const double plainTime =
+        benchmarkQueries(queries, [&](const Vertex from, const Vertex to) {
+          return query(frozen, from, to);
+        });
+    const double laidOutTime =
+        benchmarkQueries(queries, [&](const Vertex from, const Vertex to) {
+          return query(laidOut, from, to);
+        });
+    std::cout << "  Speedup of the BFS layout: " << plainTime / laidOutTime
+              << std::endl;
+  }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "types.h"
+
+// Sorts label entries, i.e. hubs with their distances in two parallel arrays.
+// A label grows by appending a batch of new entries to its sorted entries, so
+// only the batch is sorted (by a radix sort on the hubs if it is large) and
+// then merged from the back into the label. This needs scratch space for the
+// batch only, which is kept between the calls; every thread needs its own
+// instance.
+class LabelSorter {
+ public:
+  // batches with at least this many entries are radix sorted
+  static constexpr std::size_t radixSortThreshold = 256;
+
+  // Sorts the entries [0, size) by hub, where [0, sortedPrefix) is already
+  // sorted. Entries with the same hub keep their order.
+  void sort(Vertex* hubs, Distance* dists, const std::size_t sortedPrefix,
+            const std::size_t size) {
+    assert(std::is_sorted(hubs, hubs + sortedPrefix));
+    if (sortedPrefix >= size) return;
+    if (std::is_sorted(hubs + std::max<std::size_t>(sortedPrefix, 1) - 1,
+                       hubs + size)) {
+      return;
+    }
+
+    batch.resize(size - sortedPrefix);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      batch[i] = {hubs[sortedPrefix + i], dists[sortedPrefix + i]};
+    }
+    if (batch.size() < radixSortThreshold) {
+      std::stable_sort(batch.begin(), batch.end(),
+                       [](const Entry& left, const Entry& right) {
+                         return left.hub < right.hub;
+                       });
+    } else {
+      radixSort();
+    }
+
+    // the largest remaining entry of both sides moves to the end; on equal
+    // hubs, the one of the batch goes last
+    std::size_t i = sortedPrefix, j = batch.size(), out = size;
+    while (j > 0) {
+      --out;
+      if (i > 0 && hubs[i - 1] > batch[j - 1].hub) {
+        --i;
+        hubs[out] = hubs[i];
+        dists[out] = dists[i];
+      } else {
+        --j;
+        hubs[out] = batch[j].hub;
+        dists[out] = batch[j].dist;
+      }
+    }
+  }
+
+ private:
+  struct Entry {
+    Vertex hub;
+    Distance dist;
+  };
+
+  // LSD radix sort on the bytes of the hubs, without the passes for the
+  // leading zero bytes of the largest hub.
+  void radixSort() {
+    Vertex maxHub = 0;
+    for (const Entry& entry : batch) maxHub = std::max(maxHub, entry.hub);
+
+    buffer.resize(batch.size());
+    for (std::size_t shift = 0; shift < 32 && (maxHub >> shift) != 0;
+         shift += 8) {
+      std::array<std::size_t, 256> offsets{};
+      for (const Entry& entry : batch) ++offsets[(entry.hub >> shift) & 0xFF];
+
+      std::size_t sum = 0;
+      for (std::size_t& offset : offsets) {
+        const std::size_t count = offset;
+        offset = sum;
+        sum += count;
+      }
+      for (const Entry& entry : batch) {
+        buffer[offsets[(entry.hub >> shift) & 0xFF]++] = entry;
+      }
+      std::swap(batch, buffer);
+    }
+  }
+
+  std::vector<Entry> batch;
+  std::vector<Entry> buffer;
+};
+
+// The sorter of the calling thread, for labels which are sorted outside of a
+// construction store.
+inline LabelSorter& threadLocalLabelSorter() {
+  thread_local LabelSorter sorter;
+  return sorter;
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "hub_labels.h"
+#include "intersection.h"
+#include "label_sort.h"
+#include "thread_pool.h"
+#include "types.h"
+
+// Construction-time storage for the labels of one direction. A std::vector
+// based Label costs two vectors and a lock before its first entry, and every
+// growth goes through the global allocator. Here, every label is a small slot
+// which keeps its first inlineCapacity entries in place. Larger labels live in
+// blocks of per-thread arenas, which carve them out of large chunks. A label
+// that outgrows its block is relocated into a block of twice the capacity; the
+// old block is put on a free list of the thread and reused by the next label
+// of that size class.
+//
+// A label must only be modified by one thread at a time, which passes its
+// threadId to pick the arena. Reading through view() is safe while nobody
+// modifies the label, e.g. during a construction round.
+class LabelStore {
+ public:
+  // entries stored in the slot itself
+  static constexpr std::uint32_t inlineCapacity = 4;
+  // an arena requests chunks from the global allocator, which double in size
+  // from minChunkBytes up to chunkBytes
+  static constexpr std::size_t minChunkBytes = std::size_t(1) << 14;
+  static constexpr std::size_t chunkBytes = std::size_t(1) << 20;
+
+  struct Usage {
+    std::size_t liveBytes = 0;
+    std::size_t reservedBytes = 0;
+  };
+
+  explicit LabelStore(const std::size_t numLabels = 0,
+                      const std::size_t numThreads = 1)
+      : slots(numLabels), arenas(std::max<std::size_t>(numThreads, 1)) {}
+
+  std::size_t numLabels() const { return slots.size(); }
+
+  std::size_t size(const Vertex v) const { return slots[v].size; }
+
+  [[nodiscard]] LabelView view(const Vertex v) const {
+    const Slot& slot = slots[v];
+    return LabelView(slot.hubs(), slot.dists(), slot.size);
+  }
+
+  // Empties the label of v, its block is reused by the thread.
+  void clear(const std::size_t threadId, const Vertex v) {
+    Slot& slot = slots[v];
+    if (!slot.isInline()) arenas[threadId].release(slot.block, slot.capacity);
+    slot = Slot();
+  }
+
+  void add(const std::size_t threadId, const Vertex v, const Vertex hub,
+           const Distance dist) {
+    Slot& slot = slots[v];
+    reserve(threadId, slot, slot.size + 1);
+    slot.hubs()[slot.size] = hub;
+    slot.dists()[slot.size] = dist;
+    ++slot.size;
+  }
+
+  // Adds all newHubs with the same distance and sorts the label again.
+  void addAll(const std::size_t threadId, const Vertex v,
+              std::span<const Vertex> newHubs, const Distance dist) {
+    Slot& slot = slots[v];
+    const std::size_t sortedPrefix = slot.size;
+    reserve(threadId, slot, slot.size + newHubs.size());
+    std::copy(newHubs.begin(), newHubs.end(), slot.hubs() + slot.size);
+    std::fill_n(slot.dists() + slot.size, newHubs.size(), dist);
+    slot.size += newHubs.size();
+    arenas[threadId].sorter.sort(slot.hubs(), slot.dists(), sortedPrefix,
+                                 slot.size);
+  }
+
+  void sort(const std::size_t threadId, const Vertex v) {
+    Slot& slot = slots[v];
+    arenas[threadId].sorter.sort(slot.hubs(), slot.dists(), 0, slot.size);
+  }
+
+  // Keeps the smallest distance of every hub; the label has to be sorted.
+  void removeDuplicateHubs(const Vertex v) {
+    Slot& slot = slots[v];
+    Vertex* hubs = slot.hubs();
+    Distance* dists = slot.dists();
+    assert(std::is_sorted(hubs, hubs + slot.size));
+
+    std::uint32_t newSize = std::min<std::uint32_t>(slot.size, 1);
+    for (std::uint32_t i = 1; i < slot.size; ++i) {
+      if (hubs[newSize - 1] != hubs[i]) {
+        hubs[newSize] = hubs[i];
+        dists[newSize] = dists[i];
+        ++newSize;
+      } else {
+        dists[newSize - 1] = std::min(dists[newSize - 1], dists[i]);
+      }
+    }
+    slot.size = newSize;
+  }
+
+  // Removes the given hubs, which have to be sorted and contained.
+  void removeHubs(const Vertex v, std::span<const Vertex> sortedHubs) {
+    Slot& slot = slots[v];
+    Vertex* hubs = slot.hubs();
+    Distance* dists = slot.dists();
+
+    std::uint32_t newSize = 0;
+    std::size_t next = 0;
+    for (std::uint32_t i = 0; i < slot.size; ++i) {
+      if (next < sortedHubs.size() && hubs[i] == sortedHubs[next]) {
+        ++next;
+        continue;
+      }
+      hubs[newSize] = hubs[i];
+      dists[newSize] = dists[i];
+      ++newSize;
+    }
+    assert(next == sortedHubs.size());
+    slot.size = newSize;
+  }
+
+  // Copies every label into an exactly sized Label.
+  void exportTo(std::vector<Label>& labels, ThreadPool& pool) const {
+    labels.resize(slots.size());
+    pool.forBlocks(0, slots.size(),
+                   [&](std::size_t, std::size_t begin, std::size_t end) {
+                     for (std::size_t v = begin; v < end; ++v) {
+                       const LabelView label = view(v);
+                       labels[v].hubs.assign(label.hubs,
+                                             label.hubs + label.size);
+                       labels[v].dists.assign(label.dists,
+                                              label.dists + label.size);
+                     }
+                   });
+  }
+
+  // The bytes of the slots and entries, and the bytes of the slots and all
+  // chunks the arenas have allocated.
+  Usage usage() const {
+    Usage result;
+    result.liveBytes = result.reservedBytes = slots.size() * sizeof(Slot);
+    for (const Slot& slot : slots) {
+      if (!slot.isInline()) result.liveBytes += blockBytes(slot.size);
+    }
+    for (const Arena& arena : arenas) {
+      result.reservedBytes += arena.reservedBytes;
+    }
+    return result;
+  }
+
+ private:
+  static constexpr std::size_t blockBytes(const std::size_t capacity) {
+    return capacity * (sizeof(Vertex) + sizeof(Distance));
+  }
+
+  // The hubs of a block are followed by its distances.
+  struct InlineEntries {
+    Vertex hubs[inlineCapacity];
+    Distance dists[inlineCapacity];
+  };
+
+  struct Slot {
+    std::uint32_t size = 0;
+    std::uint32_t capacity = inlineCapacity;
+    union {
+      InlineEntries local;
+      Vertex* block;
+    };
+
+    Slot() : local() {}
+
+    bool isInline() const { return capacity == inlineCapacity; }
+
+    Vertex* hubs() { return isInline() ? local.hubs : block; }
+    const Vertex* hubs() const { return isInline() ? local.hubs : block; }
+
+    Distance* dists() {
+      return isInline() ? local.dists
+                        : reinterpret_cast<Distance*>(block + capacity);
+    }
+    const Distance* dists() const {
+      return isInline() ? local.dists
+                        : reinterpret_cast<const Distance*>(block + capacity);
+    }
+  };
+
+  class Arena {
+   public:
+    Vertex* allocate(const std::uint32_t capacity) {
+      std::vector<Vertex*>& blocks = freeBlocks(capacity);
+      if (!blocks.empty()) {
+        Vertex* block = blocks.back();
+        blocks.pop_back();
+        return block;
+      }
+
+      // the blocks are multiples of 8 entries, so the hubs stay aligned
+      const std::size_t bytes = blockBytes(capacity);
+      if (bytes > chunkBytes / 4) {
+        chunks.push_back(std::make_unique<std::byte[]>(bytes));
+        reservedBytes += bytes;
+        return reinterpret_cast<Vertex*>(chunks.back().get());
+      }
+      if (bytes > left) {
+        const std::size_t size = std::max(
+            bytes, std::clamp(reservedBytes, minChunkBytes, chunkBytes));
+        chunks.push_back(std::make_unique<std::byte[]>(size));
+        reservedBytes += size;
+        next = chunks.back().get();
+        left = size;
+      }
+      Vertex* block = reinterpret_cast<Vertex*>(next);
+      next += bytes;
+      left -= bytes;
+      return block;
+    }
+
+    void release(Vertex* block, const std::uint32_t capacity) {
+      freeBlocks(capacity).push_back(block);
+    }
+
+    LabelSorter sorter;
+    std::size_t reservedBytes = 0;
+
+   private:
+    // the capacities are inlineCapacity times a power of two
+    std::vector<Vertex*>& freeBlocks(const std::uint32_t capacity) {
+      const std::size_t sizeClass = std::countr_zero(capacity / inlineCapacity);
+      if (sizeClass >= freeLists.size()) freeLists.resize(sizeClass + 1);
+      return freeLists[sizeClass];
+    }
+
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    std::vector<std::vector<Vertex*>> freeLists;
+    std::byte* next = nullptr;
+    std::size_t left = 0;
+  };
+
+  // Relocates the label into a block with room for at least size entries.
+  void reserve(const std::size_t threadId, Slot& slot, const std::size_t size) {
+    if (size <= slot.capacity) return;
+
+    std::uint32_t capacity = slot.capacity;
+    while (capacity < size) capacity *= 2;
+
+    Vertex* block = arenas[threadId].allocate(capacity);
+    std::memcpy(block, slot.hubs(), slot.size * sizeof(Vertex));
+    std::memcpy(reinterpret_cast<Distance*>(block + capacity), slot.dists(),
+                slot.size * sizeof(Distance));
+    if (!slot.isInline()) arenas[threadId].release(slot.block, slot.capacity);
+
+    slot.block = block;
+    slot.capacity = capacity;
+  }
+
+  std::vector<Slot> slots;
+  std::vector<Arena> arenas;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <type_traits>
@@ -32,6 +33,8 @@ class LookupStorage {
 
   const std::vector<T>& getStorage() const { return storage_; }
 
+  void sort() { std::sort(storage_.begin(), storage_.end()); }
+
   void clear() {
     storage_.clear();
     ++current_generation_;
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Read-only memory mapping of a whole file. The mapping is released when the
+// object is destroyed.
+class MappedFile {
+ public:
+  MappedFile() = default;
+
+  explicit MappedFile(const std::string& fileName) {
+    const int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Cannot open file: " + fileName);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Cannot stat file: " + fileName);
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+
+    // mmap does not accept empty mappings
+    if (size_ > 0) {
+      void* ptr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (ptr == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Cannot map file: " + fileName);
+      }
+      data_ = static_cast<const char*>(ptr);
+    }
+    ::close(fd);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)) {}
+
+  MappedFile& operator=(MappedFile&& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) ::munmap(const_cast<char*>(data_), size_);
+  }
+
+  // Tells the kernel that the file will be read front to back.
+  void adviseSequential() const {
+    if (data_ != nullptr) {
+      ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+    }
+  }
+
+  const char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+  std::string_view view() const { return std::string_view(data_, size_); }
+
+ private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+};
\ No newline at end of file
@@ -1,31 +1,124 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
-#include <atomic>
 #include <iostream>
-#include <thread>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
 #include "../external/status_log.h"
+#include "bit_parallel.h"
+#include "candidate_set.h"
+#include "frontier.h"
 #include "graph.h"
 #include "hub_labels.h"
-#include "lookup_storage.h"
+#include "label_store.h"
+#include "thread_pool.h"
 #include "types.h"
 #include "utils.h"
 
 struct PSL {
   std::array<const Graph*, 2> graphs;
   std::array<std::vector<Label>, 2> labels;
+  std::unique_ptr<ThreadPool> ownedPool;
+  ThreadPool* pool;
   std::size_t numThreads;
+  std::vector<long long> roundBusyTime;
+
+  // Tests the candidates of a vertex against its label scattered into a dense
+  // per-thread array (numThreads * numVertices bytes), instead of merging the
+  // two labels for every candidate.
+  bool denseLookup = false;
+
+  // How the threads deduplicate the candidates of a vertex. By default, the
+  // timestamp arrays are only used while they fit into the memory budget of
+  // CandidateSet, otherwise the hashed sets are used.
+  CandidateSet::Mode candidateMode;
+
+  // Once a round adds fewer than tailYield new entries per processed vertex,
+  // the remaining labels are computed with pruned searches from the hubs of
+  // the last round instead (see finishWithPrunedSearches). 0 disables it.
+  double tailYield = 0;
+
+  // How the rounds find the candidates, see ROUND_MODE.
+  ROUND_MODE roundMode = ROUND_MODE::AUTO;
+  std::size_t numPushRounds = 0;
+
+  // Number of bit-parallel roots, each with up to 64 neighbours (see
+  // bit_parallel.h); 0 disables them. The candidates they already cover are
+  // pruned, so a query has to check bitParallelLabels as well.
+  std::size_t numBitParallelRoots = 0;
+  std::array<BitParallelTable<std::uint64_t>, 2> bitParallelLabels;
+
+  struct TailStats {
+    Distance fromDistance = 0;
+    std::size_t numSearches = 0;
+    std::size_t numFound = 0;
+    std::size_t numKept = 0;
+  } tailStats;
+
+  // The labels are built in a LabelStore per direction and copied into labels
+  // at the end of run(); this is its memory usage at that point.
+  std::array<LabelStore::Usage, 2> storeUsage;
+
+  // every direction of a round is cut into about numThreads * chunksPerThread
+  // chunks, which the threads claim one after another
+  static constexpr std::size_t chunksPerThread = 16;
 
   PSL(const Graph* fwdGraph, const Graph* bwdGraph, std::size_t numThreads = 1)
       : graphs{fwdGraph, bwdGraph},
         labels{std::vector<Label>(fwdGraph->numVertices()),
                std::vector<Label>(fwdGraph->numVertices())},
-        numThreads(numThreads) {}
+        ownedPool(std::make_unique<ThreadPool>(numThreads)),
+        pool(ownedPool.get()),
+        numThreads(pool->size()),
+        candidateMode(CandidateSet::chooseMode(fwdGraph->numVertices(),
+                                               this->numThreads)) {}
+
+  // Runs on the given pool, e.g. to share its threads with the preprocessing.
+  PSL(const Graph* fwdGraph, const Graph* bwdGraph, ThreadPool& pool)
+      : graphs{fwdGraph, bwdGraph},
+        labels{std::vector<Label>(fwdGraph->numVertices()),
+               std::vector<Label>(fwdGraph->numVertices())},
+        pool(&pool),
+        numThreads(pool.size()),
+        candidateMode(CandidateSet::chooseMode(fwdGraph->numVertices(),
+                                               this->numThreads)) {}
+
+  void showStats() const {
+    showLabelStats(labels);
+    showBusyTime(roundBusyTime);
+    if (!bitParallelLabels[FWD].empty()) {
+      const std::size_t numEntries = bitParallelLabels[FWD].numEntries() +
+                                     bitParallelLabels[BWD].numEntries();
+      std::cout << "Bit-parallel entries: " << numEntries << " ("
+                << static_cast<double>(computeTotalBytes(bitParallelLabels) /
+                                       (1024.0 * 1024.0))
+                << " megabytes)" << std::endl;
+    }
+    std::cout << "Push rounds:    " << numPushRounds << std::endl;
+    std::cout << "Construction store [megabytes]: "
+              << static_cast<double>((storeUsage[FWD].liveBytes +
+                                      storeUsage[BWD].liveBytes) /
+                                     (1024.0 * 1024.0))
+              << " live of "
+              << static_cast<double>((storeUsage[FWD].reservedBytes +
+                                      storeUsage[BWD].reservedBytes) /
+                                     (1024.0 * 1024.0))
+              << " reserved" << std::endl;
 
-  void showStats() const { showLabelStats(labels); }
+    if (tailStats.numSearches > 0) {
+      std::cout << "Pruned searches from distance "
+                << static_cast<int>(tailStats.fromDistance) << ": "
+                << tailStats.numSearches << " searches, " << tailStats.numKept
+                << " of " << tailStats.numFound << " found entries kept"
+                << std::endl;
+    }
+  }
 
   void printLabels() const {
     for (Vertex v = 0; v < graphs[FWD]->numVertices(); ++v) {
@@ -36,102 +129,452 @@ struct PSL {
     }
   }
 
+  // True if the bit-parallel labels contain a path of length at most d
+  // between u and w (from u to w for FWD).
+  bool coveredByBitParallel(const DIRECTION dir, const Vertex u, const Vertex w,
+                            const Distance d) const {
+    return !bitParallelLabels[dir].empty() &&
+           bitParallelDistance(bitParallelLabels[dir][u],
+                               bitParallelLabels[!dir][w]) <= d;
+  }
+
   void run() {
     StatusLog log("Computing Hub-Labels");
     const std::size_t numVertices = graphs[FWD]->numVertices();
-    const std::size_t chunkSizeVertices =
-        (numVertices + numThreads - 1) / numThreads;
+    tailStats = TailStats();
+    numPushRounds = 0;
 
-    std::vector<std::thread> workers;
+    bitParallelLabels = {};
+    if (numBitParallelRoots > 0) {
+      bitParallelLabels = computeBitParallelLabels<std::uint64_t>(
+          graphs, numBitParallelRoots, *pool);
+    }
 
     // lambda method to hide the parallel thread assignement over the vertices
     auto processVertices = [&](auto func) {
-      workers.clear();
-      for (std::size_t t = 0; t < numThreads; ++t) {
-        workers.emplace_back([&, t]() {
-          std::size_t start = t * chunkSizeVertices;
-          std::size_t end = std::min(start + chunkSizeVertices, numVertices);
-          func(t, static_cast<Vertex>(start), static_cast<Vertex>(end));
-        });
+      pool->forBlocks(0, numVertices,
+                      [&](std::size_t t, std::size_t start, std::size_t end) {
+                        func(t, static_cast<Vertex>(start),
+                             static_cast<Vertex>(end));
+                      });
+    };
+
+    // the vertices which can find new hubs in the next round, i.e., the ones
+    // with a neighbour which got new hubs in the last round
+    Frontier frontier(numVertices, numThreads);
+
+    // After reorderByRank, the low ids are the high degree vertices, so equal
+    // sized blocks would leave most of the work to the first thread. Instead,
+    // the items of a round (the active vertices, or the vertices with pushed
+    // candidates) are cut into chunks of about the same total weight(dir, i),
+    // which are claimed dynamically. Both directions are independent, so every
+    // (direction, chunk) pair is a task of its own.
+    auto processDirections = [&](const std::array<std::size_t, 2> numItems,
+                                 auto weight, auto func) {
+      std::array<std::vector<std::size_t>, 2> chunks;
+      for (const DIRECTION dir : {FWD, BWD}) {
+        chunks[dir] = balancedChunks(
+            numItems[dir], numThreads * chunksPerThread,
+            [&](const std::size_t i) { return weight(dir, i); });
       }
-      for (auto& thread : workers) thread.join();
+
+      const std::size_t numTasks = chunks[FWD].size() + chunks[BWD].size() - 2;
+      pool->forTasks(numTasks, [&](std::size_t t, std::size_t task) {
+        const DIRECTION dir = (task < chunks[FWD].size() - 1) ? FWD : BWD;
+        const std::size_t chunk =
+            (dir == FWD) ? task : task - (chunks[FWD].size() - 1);
+        func(dir, t, chunks[dir][chunk], chunks[dir][chunk + 1]);
+      });
     };
 
-    processVertices([&](std::size_t /* threadId */, Vertex start, Vertex end) {
+    std::array<LabelStore, 2> store{LabelStore(numVertices, numThreads),
+                                    LabelStore(numVertices, numThreads)};
+
+    // Every thread only adds to the labels of its own vertices: the FWD label
+    // of u gets the lower ranked heads of its outgoing edges, the BWD label
+    // the lower ranked tails of its incoming edges. This can add duplicate
+    // entries, which will be removed afterwards.
+    processVertices([&](std::size_t threadId, Vertex start, Vertex end) {
       for (Vertex u = start; u < end; ++u) {
-        labels[FWD][u].clear();
-        labels[BWD][u].clear();
-        labels[FWD][u].add(u, 0);
-        labels[BWD][u].add(u, 0);
+        for (const DIRECTION dir : {FWD, BWD}) {
+          store[dir].add(threadId, u, u, 0);
+          graphs[dir]->relaxAllEdges(u, [&](Vertex /* from */, Vertex to) {
+            if (to < u) store[dir].add(threadId, u, to, 1);
+          });
+        }
       }
     });
 
-    // This can add duplicate entries, which will be removed afterwards.
-    processVertices([&](std::size_t /* threadId */, Vertex start, Vertex end) {
+    // the newest distance level of every label, so a round only scans the
+    // entries with distance d - 1 of the neighbours
+    RecentLevels levels(numVertices, numThreads, 1);
+
+    // the possible duplicate entries are remove here, as well as the ones the
+    // bit-parallel labels cover. The remaining edge entries form the first
+    // distance level.
+    processVertices([&](std::size_t threadId, Vertex start, Vertex end) {
+      std::vector<Vertex> covered;
       for (Vertex u = start; u < end; ++u) {
-        graphs[FWD]->relaxAllEdges(u, [&](Vertex from, Vertex to) {
-          bool upwardEdge = (from < to);
-          const DIRECTION dir = upwardEdge ? BWD : FWD;
-          labels[dir][upwardEdge ? to : from].add(upwardEdge ? from : to, 1);
-        });
+        for (const DIRECTION dir : {FWD, BWD}) {
+          store[dir].sort(threadId, u);
+          store[dir].removeDuplicateHubs(u);
+          assert(std::is_sorted(store[dir].view(u).hubs,
+                                store[dir].view(u).hubs + store[dir].size(u)));
+
+          covered.clear();
+          store[dir].view(u).doForAll([&](Vertex hub, Distance dist) {
+            if (coveredByBitParallel(dir, u, hub, dist)) covered.push_back(hub);
+          });
+          if (!covered.empty()) store[dir].removeHubs(u, covered);
+
+          store[dir].view(u).doForAll([&](Vertex hub, Distance dist) {
+            if (dist == 1) levels.next()[threadId].add(hub);
+          });
+          levels.next()[threadId].finish(dir, u);
+        }
       }
     });
+    levels.advance(*pool);
 
-    // the possible duplicate entries are remove here.
-    processVertices([&](std::size_t /* threadId */, Vertex start, Vertex end) {
-      for (Vertex u = start; u < end; ++u) {
-        labels[FWD][u].sort();
-        labels[FWD][u].removeDuplicateHubs();
+    // a hub w of a neighbour v of u is only a candidate for u if w < u. Also
+    // counts how many candidates a push round would offer.
+    std::vector<std::size_t> numOffers(numThreads);
+    auto activateNeighbours = [&]() {
+      pool->run([&](const std::size_t threadId) {
+        numOffers[threadId] = 0;
+        levels.doForAll(
+            0, threadId,
+            [&](DIRECTION dir, Vertex v, std::span<const Vertex> newHubs) {
+              const Vertex minHub =
+                  *std::min_element(newHubs.begin(), newHubs.end());
+              graphs[!dir]->relaxAllEdges(v, [&](Vertex /* from */, Vertex u) {
+                if (minHub < u) frontier.activate(threadId, dir, u);
+              });
+              numOffers[threadId] += newHubs.size() * graphs[!dir]->degree(v);
+            });
+      });
+      frontier.collect(*pool);
+    };
 
-        labels[BWD][u].sort();
-        labels[BWD][u].removeDuplicateHubs();
+    // the new hubs of the last round offered to the vertices which have their
+    // vertex as a neighbour
+    PushedCandidates pushed(numThreads);
+    auto pushCandidates = [&]() {
+      pool->run([&](const std::size_t threadId) {
+        levels.doForAll(
+            0, threadId,
+            [&](DIRECTION dir, Vertex v, std::span<const Vertex> newHubs) {
+              graphs[!dir]->relaxAllEdges(v, [&](Vertex /* from */, Vertex u) {
+                for (const Vertex w : newHubs) {
+                  if (w < u) pushed.add(threadId, dir, u, w);
+                }
+              });
+            });
+      });
+      pushed.collect(*pool);
+    };
+
+    // Like direction-optimizing BFS: a pull round scans all edges of the
+    // active vertices, a push round only the offered candidates, but has to
+    // sort them. Measured on the example graphs, push only pays off if there
+    // are fewer offered candidates than edges to scan.
+    auto usePush = [&]() {
+      if (roundMode != ROUND_MODE::AUTO) return roundMode == ROUND_MODE::PUSH;
 
-        assert(std::is_sorted(labels[FWD][u].hubs.begin(),
-                              labels[FWD][u].hubs.end()));
-        assert(std::is_sorted(labels[BWD][u].hubs.begin(),
-                              labels[BWD][u].hubs.end()));
+      std::size_t numEdges = 0;
+      for (const DIRECTION dir : {FWD, BWD}) {
+        for (const Vertex u : frontier.get(dir)) {
+          numEdges += graphs[dir]->degree(u);
+        }
       }
-    });
+      return std::accumulate(numOffers.begin(), numOffers.end(),
+                             std::size_t(0)) < numEdges;
+    };
+    activateNeighbours();
 
     Distance d = 2;
-    std::atomic<bool> exploreNewRound = true;
+    bool exploreNewRound = !frontier.empty();
 
-    std::vector<LookupStorage<Vertex>> candidates(
-        numThreads, LookupStorage<Vertex>(numVertices));
+    std::vector<CandidateSet> candidates(
+        numThreads, CandidateSet(numVertices, candidateMode));
+    std::vector<ScatteredLabel> scattered;
+    if (denseLookup) scattered.resize(numThreads, ScatteredLabel(numVertices));
 
-    auto processDirection = [&](DIRECTION dir, const std::size_t threadId,
-                                const Vertex start, const Vertex end) {
-      for (Vertex u = start; u < end; ++u) {
-        candidates[threadId].clear();
-        graphs[dir]->relaxAllEdges(u, [&](Vertex /* from */, Vertex to) {
-          labels[dir][to].doForAll([&](Vertex w, Distance dist) {
-            if (dist == d - 1) candidates[threadId].add(w);
-          });
-        });
-
-        Label lookup(labels[dir][u]);
+    // tests the candidates of u and stages the ones which become hubs of u
+    auto addNewHubs = [&](DIRECTION dir, const std::size_t threadId,
+                          const Vertex u, std::span<const Vertex> hubs) {
+      const LabelView lookup = store[dir].view(u);
 
-        for (Vertex w : candidates[threadId].getStorage()) {
-          if (u <= w || sub_query(labels[!dir][w], lookup, d) <= d) continue;
-          labels[dir][u].add(w, d);
-          exploreNewRound.store(true, std::memory_order_relaxed);
+      if (denseLookup) {
+        // a common hub of u and w is at most min(u, w) = w, and the sorted
+        // candidates read the labels in memory order
+        assert(std::is_sorted(hubs.begin(), hubs.end()));
+        scattered[threadId].scatter(lookup);
+        for (Vertex w : hubs) {
+          if (u <= w) break;
+          if (coveredByBitParallel(dir, u, w, d) ||
+              scattered[threadId].reaches(store[!dir].view(w), w, d)) {
+            continue;
+          }
+          levels.next()[threadId].add(w);
+        }
+        scattered[threadId].reset();
+      } else {
+        for (Vertex w : hubs) {
+          if (u <= w || coveredByBitParallel(dir, u, w, d) ||
+              sub_query(store[!dir].view(w), lookup, d) <= d) {
+            continue;
+          }
+          levels.next()[threadId].add(w);
         }
-
-        // we keep all labels sorted as to allow for faster
-        labels[dir][u].sort();
       }
+      levels.next()[threadId].finish(dir, u);
+    };
+
+    auto pullRound = [&]() {
+      processDirections(
+          {frontier.get(FWD).size(), frontier.get(BWD).size()},
+          [&](DIRECTION dir, std::size_t i) {
+            return 1 + graphs[dir]->degree(frontier.get(dir)[i]);
+          },
+          [&](DIRECTION dir, std::size_t threadId, std::size_t begin,
+              std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+              const Vertex u = frontier.get(dir)[i];
+              candidates[threadId].clear();
+              graphs[dir]->relaxAllEdges(u, [&](Vertex /* from */, Vertex to) {
+                for (Vertex w : levels.get(0, dir, to)) {
+                  candidates[threadId].add(w);
+                }
+              });
+              if (denseLookup) candidates[threadId].sort();
+              addNewHubs(dir, threadId, u, candidates[threadId].getStorage());
+            }
+          });
+    };
+
+    auto pushRound = [&]() {
+      pushCandidates();
+      processDirections(
+          {pushed.size(FWD), pushed.size(BWD)},
+          [&](DIRECTION dir, std::size_t i) {
+            return 1 + pushed.candidates(dir, i).size();
+          },
+          [&](DIRECTION dir, std::size_t threadId, std::size_t begin,
+              std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+              addNewHubs(dir, threadId, pushed.vertex(dir, i),
+                         pushed.candidates(dir, i));
+            }
+          });
     };
 
+    pool->resetBusyTime();
+
     // the main algorithm. each iteration of this while loop finds new hubs with
     // one more distance than in the previous round
     while (exploreNewRound) {
-      exploreNewRound.store(false, std::memory_order_relaxed);
+      const std::size_t numProcessed =
+          frontier.get(FWD).size() + frontier.get(BWD).size();
+
+      // all labels are read-only during the round, so no locks are needed
+      if (usePush()) {
+        pushRound();
+        ++numPushRounds;
+      } else {
+        pullRound();
+      }
 
-      processVertices([&](std::size_t threadId, Vertex start, Vertex end) {
-        processDirection(FWD, threadId, start, end);
-        processDirection(BWD, threadId, start, end);
+      std::size_t numNewEntries = 0;
+      for (const StagedHubs& staged : levels.next()) {
+        numNewEntries += staged.hubs.size();
+      }
+
+      // afterwards, every thread merges the hubs it found into their labels;
+      // each of these labels is only touched by this thread
+      pool->run([&](const std::size_t threadId) {
+        levels.next()[threadId].doForAll(
+            [&](DIRECTION dir, Vertex u, std::span<const Vertex> newHubs) {
+              store[dir].addAll(threadId, u, newHubs, d);
+            });
       });
+
+      levels.advance(*pool);
+      activateNeighbours();
+      exploreNewRound = !frontier.empty();
+
+      if (exploreNewRound && numNewEntries < tailYield * numProcessed) {
+        finishWithPrunedSearches(store, levels, d);
+        break;
+      }
       d += 1;
     }
+
+    roundBusyTime = pool->busyTime();
+
+    for (const DIRECTION dir : {FWD, BWD}) {
+      storeUsage[dir] = store[dir].usage();
+      store[dir].exportTo(labels[dir], *pool);
+    }
+  }
+
+  // Computes all label entries with a distance above lastDistance. For every
+  // hub w of the newest level, a breadth-first search continues from the
+  // vertices which got w in the last round, like the pruned BFS of PLL. The
+  // searches run in parallel and only prune with the entries up to
+  // lastDistance, so they find a superset of the remaining entries. Every
+  // found entry (w, d) of u is only kept if no common hub h < w of u and w
+  // has a distance sum of at most d, which leaves exactly the entries the
+  // rounds would have added.
+  void finishWithPrunedSearches(std::array<LabelStore, 2>& store,
+                                const RecentLevels& levels,
+                                const Distance lastDistance) {
+    struct Entry {
+      DIRECTION dir;
+      Vertex vertex;
+      Vertex hub;
+      Distance dist;
+    };
+    const std::size_t numVertices = graphs[FWD]->numVertices();
+
+    auto concatenate = [&](std::vector<std::vector<Entry>>& local,
+                           auto compare) {
+      std::vector<Entry> entries;
+      for (const auto& entriesOfThread : local) {
+        entries.insert(entries.end(), entriesOfThread.begin(),
+                       entriesOfThread.end());
+      }
+      parallelSort(entries, numThreads, compare);
+      return entries;
+    };
+
+    // the begin of every run of entries with the same key, and the end
+    auto groupBy = [&](const std::vector<Entry>& entries, auto sameKey) {
+      std::vector<std::size_t> groups;
+      for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (i == 0 || !sameKey(entries[i - 1], entries[i])) groups.push_back(i);
+      }
+      groups.push_back(entries.size());
+      return groups;
+    };
+
+    auto byHub = [](const Entry& left, const Entry& right) {
+      return std::tie(left.dir, left.hub, left.vertex) <
+             std::tie(right.dir, right.hub, right.vertex);
+    };
+    auto byVertex = [](const Entry& left, const Entry& right) {
+      return std::tie(left.dir, left.vertex, left.hub) <
+             std::tie(right.dir, right.vertex, right.hub);
+    };
+
+    std::vector<std::vector<Entry>> local(numThreads);
+    pool->run([&](const std::size_t threadId) {
+      levels.doForAll(
+          0, threadId,
+          [&](DIRECTION dir, Vertex u, std::span<const Vertex> newHubs) {
+            for (const Vertex w : newHubs) {
+              local[threadId].push_back({dir, u, w, lastDistance});
+            }
+          });
+    });
+    const std::vector<Entry> seeds = concatenate(local, byHub);
+    const std::vector<std::size_t> searches =
+        groupBy(seeds, [](const Entry& left, const Entry& right) {
+          return left.dir == right.dir && left.hub == right.hub;
+        });
+
+    for (auto& entries : local) entries.clear();
+    std::vector<CandidateSet> visited(numThreads,
+                                      CandidateSet(numVertices, candidateMode));
+
+    pool->forTasks(searches.size() - 1, [&](std::size_t t, std::size_t i) {
+      const DIRECTION dir = seeds[searches[i]].dir;
+      const Vertex w = seeds[searches[i]].hub;
+      const LabelView hubLabel = store[!dir].view(w);
+
+      std::vector<Vertex> layer, nextLayer;
+      visited[t].clear();
+      visited[t].add(w);
+      for (std::size_t j = searches[i]; j < searches[i + 1]; ++j) {
+        visited[t].add(seeds[j].vertex);
+        layer.push_back(seeds[j].vertex);
+      }
+
+      // distances of infinity and beyond cannot be stored
+      for (Distance d = lastDistance + 1; d < infinity && !layer.empty();
+           ++d) {
+        nextLayer.clear();
+        for (const Vertex v : layer) {
+          graphs[!dir]->relaxAllEdges(v, [&](Vertex /* from */, Vertex u) {
+            if (u <= w || !visited[t].add(u)) return;
+            if (coveredByBitParallel(dir, u, w, d) ||
+                sub_query(hubLabel, store[dir].view(u), d) <= d) {
+              return;
+            }
+            local[t].push_back({dir, u, w, d});
+            nextLayer.push_back(u);
+          });
+        }
+        std::swap(layer, nextLayer);
+      }
+    });
+
+    const std::vector<Entry> found = concatenate(local, byVertex);
+    const std::vector<std::size_t> vertices =
+        groupBy(found, [](const Entry& left, const Entry& right) {
+          return left.dir == right.dir && left.vertex == right.vertex;
+        });
+
+    auto processVertices = [&](auto func) {
+      pool->forBlocks(0, vertices.size() - 1,
+                      [&](std::size_t t, std::size_t begin, std::size_t end) {
+                        for (std::size_t i = begin; i < end; ++i) {
+                          func(t, vertices[i], vertices[i + 1]);
+                        }
+                      });
+    };
+
+    processVertices([&](const std::size_t threadId, const std::size_t begin,
+                        const std::size_t end) {
+      LabelStore& labelStore = store[found[begin].dir];
+      for (std::size_t j = begin; j < end; ++j) {
+        labelStore.add(threadId, found[j].vertex, found[j].hub, found[j].dist);
+      }
+      labelStore.sort(threadId, found[begin].vertex);
+    });
+
+    // only hubs h < w can make the entry (w, d) redundant
+    auto below = [](const LabelView& view, const Vertex w) {
+      return LabelView(view.hubs, view.dists,
+                       std::lower_bound(view.hubs, view.hubs + view.size, w) -
+                           view.hubs);
+    };
+
+    std::vector<std::uint8_t> redundant(found.size(), false);
+    processVertices([&](const std::size_t /* threadId */,
+                        const std::size_t begin, const std::size_t end) {
+      const LabelView label = store[found[begin].dir].view(found[begin].vertex);
+      for (std::size_t j = begin; j < end; ++j) {
+        const Entry& entry = found[j];
+        const LabelView hubLabel = store[!entry.dir].view(entry.hub);
+        redundant[j] = minDistance(below(label, entry.hub),
+                                   below(hubLabel, entry.hub)) <= entry.dist;
+      }
+    });
+
+    processVertices([&](const std::size_t /* threadId */,
+                        const std::size_t begin, const std::size_t end) {
+      std::vector<Vertex> removed;
+      for (std::size_t j = begin; j < end; ++j) {
+        if (redundant[j]) removed.push_back(found[j].hub);
+      }
+      store[found[begin].dir].removeHubs(found[begin].vertex, removed);
+    });
+
+    tailStats.fromDistance = lastDistance + 1;
+    tailStats.numSearches = searches.size() - 1;
+    tailStats.numFound = found.size();
+    tailStats.numKept =
+        found.size() - std::count(redundant.begin(), redundant.end(), true);
   }
-};
+};
\ No newline at end of file
@@ -1,33 +1,26 @@
 #pragma once
 
-#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "../external/status_log.h"
 #include "graph.h"
+#include "thread_pool.h"
 #include "types.h"
 
 // This method compute the partitions V1, V2 and V3 for each vertex, as well as
 // the representation for each vertex f(v)
-std::pair<std::vector<std::uint8_t>, std::vector<Vertex>> computePartitionAndF(
-    const Graph &G, const std::size_t numThreads = 1) {
+inline std::pair<std::vector<std::uint8_t>, std::vector<Vertex>>
+computePartitionAndF(const Graph &G, ThreadPool &pool) {
   StatusLog log("Reducing the graph");
   const std::size_t n = G.numVertices();
-  const std::size_t chunkSizeVertices = (n + numThreads - 1) / numThreads;
-
-  std::vector<std::thread> workers;
 
   auto processVertices = [&](auto func) {
-    workers.clear();
-    for (std::size_t t = 0; t < numThreads; ++t) {
-      workers.emplace_back([&, t]() {
-        std::size_t start = t * chunkSizeVertices;
-        std::size_t end = std::min(start + chunkSizeVertices, n);
-        func(t, static_cast<Vertex>(start), static_cast<Vertex>(end));
-      });
-    }
-    for (auto &thread : workers) thread.join();
+    pool.forBlocks(0, n,
+                   [&](std::size_t t, std::size_t start, std::size_t end) {
+                     func(t, static_cast<Vertex>(start),
+                          static_cast<Vertex>(end));
+                   });
   };
 
   std::vector<std::vector<Vertex>> openAdj(n), closedAdj(n);
@@ -135,4 +128,10 @@ std::pair<std::vector<std::uint8_t>, std::vector<Vertex>> computePartitionAndF(
   });
 
   return {partition, f};
+}
+
+inline std::pair<std::vector<std::uint8_t>, std::vector<Vertex>>
+computePartitionAndF(const Graph &G, const std::size_t numThreads = 1) {
+  ThreadPool pool(numThreads);
+  return computePartitionAndF(G, pool);
 }
\ No newline at end of file
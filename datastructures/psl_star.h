@@ -1,17 +1,22 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
-#include <atomic>
 #include <iostream>
-#include <thread>
+#include <memory>
+#include <numeric>
+#include <span>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "../external/status_log.h"
+#include "candidate_set.h"
+#include "frontier.h"
 #include "graph.h"
 #include "hub_labels.h"
-#include "lookup_storage.h"
+#include "label_store.h"
+#include "thread_pool.h"
 #include "types.h"
 #include "utils.h"
 
@@ -23,7 +28,25 @@ class PSLStar {
         graphs{fwdGraph, bwdGraph},
         labels{std::vector<Label>(fwdGraph->numVertices()),
                std::vector<Label>(fwdGraph->numVertices())},
-        numThreads(numThreads) {
+        ownedPool(std::make_unique<ThreadPool>(numThreads)),
+        pool(ownedPool.get()),
+        numThreads(pool->size()),
+        candidateMode(CandidateSet::chooseMode(fwdGraph->numVertices(),
+                                               this->numThreads)) {
+    computeLocalMinima();
+    buildNeighbours();
+  }
+
+  // Runs on the given pool, e.g. to share its threads with the preprocessing.
+  PSLStar(const Graph* fwdGraph, const Graph* bwdGraph, ThreadPool& pool)
+      : localMaximum(fwdGraph->numVertices(), false),
+        graphs{fwdGraph, bwdGraph},
+        labels{std::vector<Label>(fwdGraph->numVertices()),
+               std::vector<Label>(fwdGraph->numVertices())},
+        pool(&pool),
+        numThreads(pool.size()),
+        candidateMode(CandidateSet::chooseMode(fwdGraph->numVertices(),
+                                               this->numThreads)) {
     computeLocalMinima();
     buildNeighbours();
   }
@@ -31,13 +54,47 @@ class PSLStar {
   void run();
   void printNeighbours() const;
   void printLabels() const;
-  void showStats() const { showLabelStats(labels); }
+  void showStats() const {
+    showLabelStats(labels);
+    showBusyTime(roundBusyTime);
+    std::cout << "Push rounds:    " << numPushRounds << std::endl;
+    std::cout << "Construction store [megabytes]: "
+              << static_cast<double>((storeUsage[FWD].liveBytes +
+                                      storeUsage[BWD].liveBytes) /
+                                     (1024.0 * 1024.0))
+              << " live of "
+              << static_cast<double>((storeUsage[FWD].reservedBytes +
+                                      storeUsage[BWD].reservedBytes) /
+                                     (1024.0 * 1024.0))
+              << " reserved" << std::endl;
+  }
 
   std::vector<bool> localMaximum;
   std::array<const Graph*, 2> graphs;
   std::array<std::array<std::vector<std::vector<Vertex>>, 2>, 2> neighbours;
   std::array<std::vector<Label>, 2> labels;
+  std::unique_ptr<ThreadPool> ownedPool;
+  ThreadPool* pool;
   std::size_t numThreads;
+  std::vector<long long> roundBusyTime;
+
+  // Tests the candidates of a vertex against its label scattered into a dense
+  // per-thread array, see PSL::denseLookup.
+  bool denseLookup = false;
+
+  // How the threads deduplicate the candidates, see PSL::candidateMode.
+  CandidateSet::Mode candidateMode;
+
+  // How the rounds find the candidates, see ROUND_MODE.
+  ROUND_MODE roundMode = ROUND_MODE::AUTO;
+  std::size_t numPushRounds = 0;
+
+  // Memory usage of the construction stores, see PSL::storeUsage.
+  std::array<LabelStore::Usage, 2> storeUsage;
+
+  // every direction of a round is cut into about numThreads * chunksPerThread
+  // chunks, which the threads claim one after another
+  static constexpr std::size_t chunksPerThread = 16;
 
   void computeLocalMinima();
   void buildNeighbours();
@@ -132,6 +189,7 @@ void PSLStar::printLabels() const {
 void PSLStar::run() {
   StatusLog log("Computing Hub-Labels");
   const std::size_t numVertices = graphs[FWD]->numVertices();
+  numPushRounds = 0;
 
   std::vector<Vertex> roots;
   roots.reserve(numVertices);
@@ -140,117 +198,282 @@ void PSLStar::run() {
     if (!localMaximum[v]) roots.emplace_back(v);
   }
 
-  // const std::size_t chunkSizeVertices = (numVertices + numThreads - 1) /
-  // numThreads;
-  const std::size_t chunkSizeRoots =
-      (roots.size() + numThreads - 1) / numThreads;
-
-  std::vector<std::thread> workers;
-
   // lambda method to hide the parallel thread assignement over the vertices
   auto processVertices = [&](auto func) {
-    workers.clear();
-    for (std::size_t t = 0; t < numThreads; ++t) {
-      workers.emplace_back([&, t]() {
-        std::size_t start = t * chunkSizeRoots;
-        std::size_t end = std::min(start + chunkSizeRoots, roots.size());
-        func(t, start, end);
-      });
+    pool->forBlocks(0, roots.size(), func);
+  };
+
+  // the roots which can find new hubs in the next round, i.e., the ones with
+  // a first (second) order neighbour which got new hubs in the last (second
+  // last) round
+  Frontier frontier(numVertices, numThreads);
+
+  // the items of a round (the active roots, or the roots with pushed
+  // candidates) are cut into chunks of about the same total weight(dir, i),
+  // which the threads claim dynamically. Both directions are independent, so
+  // every (direction, chunk) pair is a task.
+  auto processDirections = [&](const std::array<std::size_t, 2> numItems,
+                               auto weight, auto func) {
+    std::array<std::vector<std::size_t>, 2> chunks;
+    for (const DIRECTION dir : {FWD, BWD}) {
+      chunks[dir] = balancedChunks(
+          numItems[dir], numThreads * chunksPerThread,
+          [&](const std::size_t i) { return weight(dir, i); });
     }
-    for (auto& thread : workers) thread.join();
+
+    const std::size_t numTasks = chunks[FWD].size() + chunks[BWD].size() - 2;
+    pool->forTasks(numTasks, [&](std::size_t t, std::size_t task) {
+      const DIRECTION dir = (task < chunks[FWD].size() - 1) ? FWD : BWD;
+      const std::size_t chunk =
+          (dir == FWD) ? task : task - (chunks[FWD].size() - 1);
+      func(dir, t, chunks[dir][chunk], chunks[dir][chunk + 1]);
+    });
   };
 
+  // the two newest distance levels of every label, as the first and second
+  // order neighbours contribute the entries with distance d - 1 and d - 2
+  RecentLevels levels(numVertices, numThreads, 2);
+
+  std::array<LabelStore, 2> store{LabelStore(numVertices, numThreads),
+                                  LabelStore(numVertices, numThreads)};
+
   processVertices(
-      [&](std::size_t /* threadId */, std::size_t start, std::size_t end) {
+      [&](std::size_t threadId, std::size_t start, std::size_t end) {
         for (std::size_t i = start; i < end; ++i) {
           Vertex u = roots[i];
-          labels[FWD][u].clear();
-          labels[BWD][u].clear();
-          labels[FWD][u].add(u, 0);
-          labels[BWD][u].add(u, 0);
+          for (const DIRECTION dir : {FWD, BWD}) {
+            store[dir].add(threadId, u, u, 0);
+            levels.next()[threadId].add(u);
+            levels.next()[threadId].finish(dir, u);
+          }
         }
       });
+  levels.advance(*pool);
 
-  // This can add duplicate entries, which will be removed afterwards.
+  // Every thread only adds to the labels of its own roots: the lower ranked
+  // first order neighbours of u in direction dir. This can add duplicate
+  // entries, which will be removed afterwards.
   processVertices(
-      [&](std::size_t /* threadId */, std::size_t start, std::size_t end) {
+      [&](std::size_t threadId, std::size_t start, std::size_t end) {
         for (std::size_t i = start; i < end; ++i) {
           Vertex u = roots[i];
-          for (const Vertex to : getN1(u, FWD)) {
-            bool upwardEdge = (u < to);
-            const DIRECTION dir = upwardEdge ? BWD : FWD;
-            labels[dir][upwardEdge ? to : u].add(upwardEdge ? u : to, 1);
+          for (const DIRECTION dir : {FWD, BWD}) {
+            for (const Vertex to : getN1(u, dir)) {
+              if (to < u) store[dir].add(threadId, u, to, 1);
+            }
           }
         }
       });
 
-  // the possible duplicate entries are remove here.
+  // the possible duplicate entries are remove here. The remaining edge
+  // entries form the distance level 1.
   processVertices(
-      [&](std::size_t /* threadId */, std::size_t start, std::size_t end) {
+      [&](std::size_t threadId, std::size_t start, std::size_t end) {
         for (std::size_t i = start; i < end; ++i) {
           Vertex u = roots[i];
 
-          labels[FWD][u].sort();
-          labels[FWD][u].removeDuplicateHubs();
-
-          labels[BWD][u].sort();
-          labels[BWD][u].removeDuplicateHubs();
-
-          assert(std::is_sorted(labels[FWD][u].hubs.begin(),
-                                labels[FWD][u].hubs.end()));
-          assert(std::is_sorted(labels[BWD][u].hubs.begin(),
-                                labels[BWD][u].hubs.end()));
+          for (const DIRECTION dir : {FWD, BWD}) {
+            store[dir].sort(threadId, u);
+            store[dir].removeDuplicateHubs(u);
+            assert(std::is_sorted(
+                store[dir].view(u).hubs,
+                store[dir].view(u).hubs + store[dir].size(u)));
+
+            store[dir].view(u).doForAll([&](Vertex hub, Distance dist) {
+              if (dist == 1) levels.next()[threadId].add(hub);
+            });
+            levels.next()[threadId].finish(dir, u);
+          }
         }
       });
+  levels.advance(*pool);
+
+  // the reverse of getN1 and getN2: calls offer(dir, u, newHubs, minHub)
+  // for every root u with x in N1(u) (N2(u)), where x got newHubs in the last
+  // (second last) round.
+  auto forEachOffer = [&](const std::size_t threadId, auto offer) {
+    levels.doForAll(
+        0, threadId,
+        [&](DIRECTION dir, Vertex x, std::span<const Vertex> newHubs) {
+          const Vertex minHub =
+              *std::min_element(newHubs.begin(), newHubs.end());
+          graphs[!dir]->relaxAllEdges(x, [&](Vertex, Vertex u) {
+            if (!localMaximum[u]) offer(dir, u, newHubs, minHub);
+          });
+        });
+    levels.doForAll(
+        1, threadId,
+        [&](DIRECTION dir, Vertex x, std::span<const Vertex> newHubs) {
+          const Vertex minHub =
+              *std::min_element(newHubs.begin(), newHubs.end());
+          graphs[!dir]->relaxAllEdges(x, [&](Vertex, Vertex hub) {
+            if (!localMaximum[hub]) return;
+            graphs[!dir]->relaxAllEdges(hub, [&](Vertex, Vertex u) {
+              if (u != x && !localMaximum[u]) offer(dir, u, newHubs, minHub);
+            });
+          });
+        });
+  };
 
-  Distance d = 2;
-  std::atomic<bool> exploreNewRound = true;
-
-  std::vector<LookupStorage<Vertex>> candidates(
-      numThreads, LookupStorage<Vertex>(numVertices));
+  // A hub w of x is only a candidate for u if w < u. Also counts how many
+  // candidates a push round would offer.
+  std::vector<std::size_t> numOffers(numThreads);
+  auto activateNeighbours = [&]() {
+    pool->run([&](const std::size_t threadId) {
+      numOffers[threadId] = 0;
+      forEachOffer(threadId, [&](DIRECTION dir, Vertex u,
+                                 std::span<const Vertex> newHubs,
+                                 Vertex minHub) {
+        if (minHub < u) frontier.activate(threadId, dir, u);
+        numOffers[threadId] += newHubs.size();
+      });
+    });
+    frontier.collect(*pool);
+  };
 
-  auto processDirection = [&](DIRECTION dir, const std::size_t threadId,
-                              std::size_t start, std::size_t end) {
-    for (std::size_t i = start; i < end; ++i) {
-      Vertex u = roots[i];
+  PushedCandidates pushed(numThreads);
+  auto pushCandidates = [&]() {
+    pool->run([&](const std::size_t threadId) {
+      forEachOffer(threadId, [&](DIRECTION dir, Vertex u,
+                                 std::span<const Vertex> newHubs, Vertex) {
+        for (const Vertex w : newHubs) {
+          if (w < u) pushed.add(threadId, dir, u, w);
+        }
+      });
+    });
+    pushed.collect(*pool);
+  };
 
-      candidates[threadId].clear();
+  // see PSL::run
+  auto usePush = [&]() {
+    if (roundMode != ROUND_MODE::AUTO) return roundMode == ROUND_MODE::PUSH;
 
-      for (Vertex to : getN1(u, dir)) {
-        labels[dir][to].doForAll([&](Vertex w, Distance dist) {
-          if (dist == d - 1) candidates[threadId].add(w);
-        });
+    std::size_t numNeighbours = 0;
+    for (const DIRECTION dir : {FWD, BWD}) {
+      for (const Vertex u : frontier.get(dir)) {
+        numNeighbours += getN1(u, dir).size() + getN2(u, dir).size();
       }
+    }
+    return std::accumulate(numOffers.begin(), numOffers.end(),
+                           std::size_t(0)) < numNeighbours;
+  };
+  activateNeighbours();
 
-      for (Vertex to : getN2(u, dir)) {
-        labels[dir][to].doForAll([&](Vertex w, Distance dist) {
-          if (dist == d - 2) candidates[threadId].add(w);
-        });
+  Distance d = 2;
+  bool exploreNewRound = !frontier.empty();
+
+  std::vector<CandidateSet> candidates(
+      numThreads, CandidateSet(numVertices, candidateMode));
+  std::vector<ScatteredLabel> scattered;
+  if (denseLookup) scattered.resize(numThreads, ScatteredLabel(numVertices));
+
+  // tests the candidates of u and stages the ones which become hubs of u
+  auto addNewHubs = [&](DIRECTION dir, const std::size_t threadId,
+                        const Vertex u, std::span<const Vertex> hubs) {
+    const LabelView lookup = store[dir].view(u);
+
+    if (denseLookup) {
+      assert(std::is_sorted(hubs.begin(), hubs.end()));
+      scattered[threadId].scatter(lookup);
+      for (Vertex w : hubs) {
+        if (u <= w) break;
+        if (scattered[threadId].reaches(store[!dir].view(w), w, d)) {
+          continue;
+        }
+        levels.next()[threadId].add(w);
       }
-
-      Label lookup(labels[dir][u]);
-
-      for (Vertex w : candidates[threadId].getStorage()) {
-        if (u <= w || sub_query(labels[!dir][w], lookup, d) <= d) continue;
-        labels[dir][u].add(w, d);
-        exploreNewRound.store(true, std::memory_order_relaxed);
+      scattered[threadId].reset();
+    } else {
+      for (Vertex w : hubs) {
+        if (u <= w || sub_query(store[!dir].view(w), lookup, d) <= d) {
+          continue;
+        }
+        levels.next()[threadId].add(w);
       }
-
-      // we keep all labels sorted as to allow for faster
-      labels[dir][u].sort();
     }
+    levels.next()[threadId].finish(dir, u);
+  };
+
+  auto pullRound = [&]() {
+    processDirections(
+        {frontier.get(FWD).size(), frontier.get(BWD).size()},
+        [&](DIRECTION dir, std::size_t i) {
+          const Vertex u = frontier.get(dir)[i];
+          return 1 + getN1(u, dir).size() + getN2(u, dir).size();
+        },
+        [&](DIRECTION dir, std::size_t threadId, std::size_t begin,
+            std::size_t end) {
+          for (std::size_t i = begin; i < end; ++i) {
+            const Vertex u = frontier.get(dir)[i];
+            candidates[threadId].clear();
+
+            for (Vertex to : getN1(u, dir)) {
+              for (Vertex w : levels.get(0, dir, to)) {
+                candidates[threadId].add(w);
+              }
+            }
+
+            for (Vertex to : getN2(u, dir)) {
+              for (Vertex w : levels.get(1, dir, to)) {
+                candidates[threadId].add(w);
+              }
+            }
+
+            if (denseLookup) candidates[threadId].sort();
+            addNewHubs(dir, threadId, u, candidates[threadId].getStorage());
+          }
+        });
   };
 
+  auto pushRound = [&]() {
+    pushCandidates();
+    processDirections(
+        {pushed.size(FWD), pushed.size(BWD)},
+        [&](DIRECTION dir, std::size_t i) {
+          return 1 + pushed.candidates(dir, i).size();
+        },
+        [&](DIRECTION dir, std::size_t threadId, std::size_t begin,
+            std::size_t end) {
+          for (std::size_t i = begin; i < end; ++i) {
+            addNewHubs(dir, threadId, pushed.vertex(dir, i),
+                       pushed.candidates(dir, i));
+          }
+        });
+  };
+
+  pool->resetBusyTime();
+
   // the main algorithm. each iteration of this while loop finds new hubs with
   // one more distance than in the previous round
   while (exploreNewRound) {
-    exploreNewRound.store(false, std::memory_order_relaxed);
+    // all labels are read-only during the round, so no locks are needed
+    if (usePush()) {
+      pushRound();
+      ++numPushRounds;
+    } else {
+      pullRound();
+    }
 
-    processVertices(
-        [&](std::size_t threadId, std::size_t start, std::size_t end) {
-          processDirection(FWD, threadId, start, end);
-          processDirection(BWD, threadId, start, end);
-        });
+    // afterwards, every thread merges the hubs it found into their labels;
+    // each of these labels is only touched by this thread
+    pool->run([&](const std::size_t threadId) {
+      levels.next()[threadId].doForAll(
+          [&](DIRECTION dir, Vertex u, std::span<const Vertex> newHubs) {
+            store[dir].addAll(threadId, u, newHubs, d);
+          });
+    });
+
+    exploreNewRound = !levels.nextIsEmpty();
+    levels.advance(*pool);
+    activateNeighbours();
+    exploreNewRound &= !frontier.empty();
     d += 1;
   }
+
+  roundBusyTime = pool->busyTime();
+
+  for (const DIRECTION dir : {FWD, BWD}) {
+    storeUsage[dir] = store[dir].usage();
+    store[dir].exportTo(labels[dir], *pool);
+  }
 }
\ No newline at end of file
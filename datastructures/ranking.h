@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../external/status_log.h"
+#include "graph.h"
+#include "mapped_file.h"
+#include "text_parsing.h"
+#include "types.h"
+#include "utils.h"
+
+// Vertex orderings for Graph::reorderByRank. Every ordering returns a rank
+// with rank[v] being the new id of v; the most important vertex gets id 0.
+enum class ORDERING { DEGREE, DEGREE_PRODUCT, PATH_COVERAGE, RANK_FILE };
+
+inline ORDERING parseOrdering(const std::string &name) {
+  if (name == "degree") return ORDERING::DEGREE;
+  if (name == "product") return ORDERING::DEGREE_PRODUCT;
+  if (name == "coverage") return ORDERING::PATH_COVERAGE;
+  if (name == "file") return ORDERING::RANK_FILE;
+  throw std::runtime_error("Unknown vertex ordering: " + name);
+}
+
+// Sorts the vertices by descending score(v) and returns their rank. Ties are
+// broken by a fixed random permutation, so the rank does not depend on the
+// number of threads.
+template <typename SCORE>
+std::vector<std::size_t> rankByScore(const std::size_t n,
+                                     const std::size_t numThreads,
+                                     SCORE &&score) {
+  std::vector<std::size_t> randomNumber(n);
+  std::iota(randomNumber.begin(), randomNumber.end(), 0);
+
+  std::mt19937 randomGenerator(42);
+  std::shuffle(randomNumber.begin(), randomNumber.end(), randomGenerator);
+
+  std::vector<std::size_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+
+  parallelSort(order, numThreads,
+               [&](const std::size_t left, const std::size_t right) {
+                 return std::pair(score(left), randomNumber[left]) >
+                        std::pair(score(right), randomNumber[right]);
+               });
+
+  std::vector<std::size_t> rank(n);
+  parallelForBlocks(
+      numThreads, 0, n,
+      [&](std::size_t, const std::size_t begin, const std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) rank[order[i]] = i;
+      });
+  return rank;
+}
+
+// Returns the out- and in-degree of every vertex.
+inline std::array<std::vector<std::size_t>, 2> computeDegrees(
+    const Graph &G, const std::size_t numThreads = 1) {
+  const std::size_t n = G.numVertices();
+  std::array<std::vector<std::size_t>, 2> degrees = {
+      std::vector<std::size_t>(n, 0), std::vector<std::size_t>(n, 0)};
+
+  parallelForBlocks(
+      numThreads, 0, n,
+      [&](std::size_t, const std::size_t begin, const std::size_t end) {
+        for (Vertex v = begin; v < end; ++v) {
+          degrees[FWD][v] = G.degree(v);
+          G.relaxAllEdges(v, [&](const Vertex /* from */, const Vertex to) {
+            std::atomic_ref<std::size_t>(degrees[BWD][to])
+                .fetch_add(1, std::memory_order_relaxed);
+          });
+        }
+      });
+  return degrees;
+}
+
+// Total degree (in + out).
+inline std::vector<std::size_t> degreeRank(const Graph &G,
+                                           const std::size_t numThreads = 1) {
+  StatusLog log("Computing degree order");
+  const auto degrees = computeDegrees(G, numThreads);
+  return rankByScore(G.numVertices(), numThreads, [&](const std::size_t v) {
+    return degrees[FWD][v] + degrees[BWD][v];
+  });
+}
+
+// Product of in- and out-degree, which favours vertices many paths can pass
+// through. Vertices without in- or out-edges are ordered by total degree.
+inline std::vector<std::size_t> degreeProductRank(
+    const Graph &G, const std::size_t numThreads = 1) {
+  StatusLog log("Computing degree product order");
+  const auto degrees = computeDegrees(G, numThreads);
+  return rankByScore(G.numVertices(), numThreads, [&](const std::size_t v) {
+    return std::pair(degrees[FWD][v] * degrees[BWD][v],
+                     degrees[FWD][v] + degrees[BWD][v]);
+  });
+}
+
+// Grows forward and backward BFS trees from numSamples random roots and counts
+// for every vertex how many tree paths (i.e. sampled shortest paths) pass
+// through it, which is the size of its subtree. The trees are distributed
+// over the threads; ties are broken by total degree.
+inline std::vector<std::size_t> pathCoverageRank(
+    const Graph &G, const std::size_t numThreads = 1,
+    const std::size_t numSamples = 16) {
+  const std::size_t n = G.numVertices();
+  if (n == 0) return {};
+
+  const Graph reversed = G.reverseGraph(numThreads);
+
+  StatusLog log("Computing path coverage order");
+  const auto degrees = computeDegrees(G, numThreads);
+
+  std::vector<Vertex> roots(n);
+  std::iota(roots.begin(), roots.end(), 0);
+  std::shuffle(roots.begin(), roots.end(), std::mt19937(42));
+  roots.resize(std::min(numSamples, n));
+
+  // there are only 2 * numSamples trees, and every worker needs n-sized
+  // arrays, so no more workers than trees are started. They all add to one
+  // coverage array.
+  const std::size_t numWorkers =
+      std::max<std::size_t>(1, std::min(numThreads, 2 * roots.size()));
+  std::vector<std::size_t> coverage(n, 0);
+
+  parallelForBlocks(
+      numWorkers, 0, 2 * roots.size(),
+      [&](std::size_t, const std::size_t begin, const std::size_t end) {
+        if (begin >= end) return;
+        std::vector<Vertex> parent(n, noVertex);
+        std::vector<std::size_t> subtree(n, 0);
+        std::vector<Vertex> visited;
+        visited.reserve(n);
+
+        for (std::size_t i = begin; i < end; ++i) {
+          const Graph &graph = (i % 2 == 0) ? G : reversed;
+          const Vertex root = roots[i / 2];
+
+          visited.clear();
+          visited.push_back(root);
+          parent[root] = root;
+          for (std::size_t head = 0; head < visited.size(); ++head) {
+            graph.relaxAllEdges(visited[head],
+                                [&](const Vertex from, const Vertex to) {
+                                  if (parent[to] != noVertex) return;
+                                  parent[to] = from;
+                                  visited.push_back(to);
+                                });
+          }
+
+          // accumulate the subtree sizes bottom up, in reverse BFS order
+          for (std::size_t j = visited.size(); j-- > 0;) {
+            const Vertex v = visited[j];
+            subtree[v] += 1;
+            if (v != root) subtree[parent[v]] += subtree[v];
+            std::atomic_ref<std::size_t>(coverage[v]).fetch_add(
+                subtree[v], std::memory_order_relaxed);
+          }
+
+          for (const Vertex v : visited) {
+            parent[v] = noVertex;
+            subtree[v] = 0;
+          }
+        }
+      });
+
+  return rankByScore(n, numThreads, [&](const std::size_t v) {
+    return std::pair(coverage[v], degrees[FWD][v] + degrees[BWD][v]);
+  });
+}
+
+// Reads a user-supplied order: every non-empty line contains one (1-indexed)
+// vertex id, from the most to the least important vertex. Every vertex has to
+// appear exactly once.
+inline std::vector<std::size_t> readRankFile(const std::string &fileName,
+                                             const std::size_t n) {
+  StatusLog log("Reading vertex order");
+  MappedFile file(fileName);
+  file.adviseSequential();
+
+  std::vector<std::size_t> rank(n, noIndex);
+  std::size_t position = 0;
+
+  forEachLine(file.view(), [&](std::string_view line) {
+    const char *pos = line.data();
+    const char *end = line.data() + line.size();
+    if (onlyBlanksLeft(pos, end)) return;
+
+    std::size_t v;
+    if (!parseNext(pos, end, v) || !onlyBlanksLeft(pos, end) || v == 0 ||
+        v > n || rank[v - 1] != noIndex) {
+      throw std::runtime_error("Invalid line in rank file " + fileName + ": " +
+                               std::string(line));
+    }
+    rank[v - 1] = position++;
+  });
+
+  if (position != n) {
+    throw std::runtime_error("Rank file " + fileName + " contains " +
+                             std::to_string(position) + " of " +
+                             std::to_string(n) + " vertices.");
+  }
+  return rank;
+}
+
+inline std::vector<std::size_t> computeRank(
+    const Graph &G, const ORDERING ordering, const std::size_t numThreads = 1,
+    const std::string &rankFileName = "") {
+  switch (ordering) {
+    case ORDERING::DEGREE_PRODUCT:
+      return degreeProductRank(G, numThreads);
+    case ORDERING::PATH_COVERAGE:
+      return pathCoverageRank(G, numThreads);
+    case ORDERING::RANK_FILE:
+      return readRankFile(rankFileName, G.numVertices());
+    case ORDERING::DEGREE:
+    default:
+      return degreeRank(G, numThreads);
+  }
+}
\ No newline at end of file
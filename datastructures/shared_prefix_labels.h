@@ -0,0 +1,292 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+#include "../external/status_log.h"
+#include "frozen_labels.h"
+#include "hub_labels.h"
+#include "intersection.h"
+#include "types.h"
+#include "utils.h"
+
+// Labels of one direction whose common hub prefixes are stored only once. On
+// small-world graphs, most labels start with the same top ranked hubs, though
+// rarely at exactly the same distances. So the hubs of every label are split
+// into a prefix from a shared dictionary and a private tail, while all
+// distances stay with the label (a LabelView points to hubs and distances
+// separately). The candidate prefixes have the lengths minPrefixLength,
+// 2 * minPrefixLength, ... up to maxPrefixLength; a label takes the longest one
+// it shares with at least minShare labels. Prefix and tail are both sorted
+// runs, so a query intersects up to four pairs of runs with the kernels of
+// intersection.h, without expanding a label.
+struct SharedPrefixLabels {
+  static constexpr std::uint32_t noPrefix = std::uint32_t(-1);
+
+  std::size_t minPrefixLength = 4;
+  std::size_t maxPrefixLength = 4096;
+  std::size_t minShare = 2;
+
+  // prefix p is prefixHubs[prefixOffsets[p], prefixOffsets[p + 1]), the
+  // tail of v is tailHubs[tailOffsets[v], tailOffsets[v + 1]) and all its
+  // distances are dists[offsets[v], offsets[v + 1])
+  std::vector<std::size_t> prefixOffsets;
+  std::vector<Vertex> prefixHubs;
+
+  std::vector<std::uint32_t> prefix;
+  std::vector<std::size_t> tailOffsets;
+  std::vector<Vertex> tailHubs;
+  std::vector<std::size_t> offsets;
+  std::vector<Distance> dists;
+
+  SharedPrefixLabels()
+      : prefixOffsets(1, 0), tailOffsets(1, 0), offsets(1, 0) {}
+
+  explicit SharedPrefixLabels(const std::vector<Label>& labels,
+                              const std::size_t numThreads = 1)
+      : SharedPrefixLabels() {
+    build(labels, numThreads);
+  }
+
+  std::size_t numVertices() const { return prefix.size(); }
+  std::size_t numPrefixes() const { return prefixOffsets.size() - 1; }
+
+  std::size_t size(const Vertex v) const {
+    return offsets[v + 1] - offsets[v];
+  }
+
+  LabelView prefixOf(const Vertex v) const {
+    if (prefix[v] == noPrefix) return LabelView();
+    const std::size_t begin = prefixOffsets[prefix[v]];
+    return LabelView(prefixHubs.data() + begin, dists.data() + offsets[v],
+                     prefixOffsets[prefix[v] + 1] - begin);
+  }
+
+  LabelView tailOf(const Vertex v) const {
+    const std::size_t tailSize = tailOffsets[v + 1] - tailOffsets[v];
+    return LabelView(tailHubs.data() + tailOffsets[v],
+                     dists.data() + offsets[v + 1] - tailSize, tailSize);
+  }
+
+  std::size_t computeTotalBytes() const {
+    return sizeof(SharedPrefixLabels) +
+           prefixOffsets.capacity() * sizeof(std::size_t) +
+           prefixHubs.capacity() * sizeof(Vertex) +
+           prefix.capacity() * sizeof(std::uint32_t) +
+           tailOffsets.capacity() * sizeof(std::size_t) +
+           tailHubs.capacity() * sizeof(Vertex) +
+           offsets.capacity() * sizeof(std::size_t) +
+           dists.capacity() * sizeof(Distance);
+  }
+
+  void build(const std::vector<Label>& labels, const std::size_t numThreads) {
+    const std::size_t n = labels.size();
+    std::vector<std::size_t> lengths;
+    for (std::size_t length = minPrefixLength; length <= maxPrefixLength;
+         length *= 2) {
+      lengths.push_back(length);
+    }
+
+    // the hash of every prefix of a candidate length, sorted so that the
+    // labels with equal prefixes form runs
+    struct Key {
+      std::uint64_t hash;
+      std::uint32_t length;
+      Vertex vertex;
+    };
+    std::vector<std::vector<Key>> localKeys(numThreads);
+    parallelForBlocks(
+        numThreads, 0, n,
+        [&](std::size_t t, std::size_t begin, std::size_t end) {
+          for (std::size_t v = begin; v < end; ++v) {
+            const Label& label = labels[v];
+            std::uint64_t hash = 0;
+            std::size_t next = 0;
+            for (std::size_t i = 0;
+                 i < label.hubs.size() && next < lengths.size(); ++i) {
+              hash = (hash ^ std::uint64_t(label.hubs[i])) *
+                     0x9E3779B97F4A7C15ull;
+              if (i + 1 == lengths[next]) {
+                localKeys[t].push_back({hash,
+                                        static_cast<std::uint32_t>(i + 1),
+                                        static_cast<Vertex>(v)});
+                ++next;
+              }
+            }
+          }
+        });
+    std::vector<Key> keys;
+    for (const auto& keysOfThread : localKeys) {
+      keys.insert(keys.end(), keysOfThread.begin(), keysOfThread.end());
+    }
+    parallelSort(keys, numThreads, [](const Key& left, const Key& right) {
+      return std::tie(left.length, left.hash, left.vertex) <
+             std::tie(right.length, right.hash, right.vertex);
+    });
+
+    auto samePrefix = [&](const Vertex v, const Vertex w,
+                          const std::size_t length) {
+      return std::equal(labels[v].hubs.begin(),
+                        labels[v].hubs.begin() + length,
+                        labels[w].hubs.begin());
+    };
+
+    // the first label of a run represents its prefix; every label picks the
+    // longest shared prefix, which is equal to the one of the representative
+    // (the hashes can collide)
+    std::vector<Vertex> representative(n, noVertex);
+    std::vector<std::uint32_t> prefixLength(n, 0);
+    for (std::size_t begin = 0, end = 0; begin < keys.size(); begin = end) {
+      end = begin + 1;
+      while (end < keys.size() && keys[end].length == keys[begin].length &&
+             keys[end].hash == keys[begin].hash) {
+        ++end;
+      }
+      if (end - begin < minShare) continue;
+
+      const Vertex first = keys[begin].vertex;
+      for (std::size_t i = begin; i < end; ++i) {
+        const Vertex v = keys[i].vertex;
+        if (samePrefix(first, v, keys[i].length)) {
+          representative[v] = first;
+          prefixLength[v] = keys[i].length;
+        }
+      }
+    }
+
+    // one dictionary entry per used (representative, length) pair
+    std::vector<std::tuple<std::uint32_t, Vertex, Vertex>> uses;
+    for (Vertex v = 0; v < n; ++v) {
+      if (prefixLength[v] > 0) {
+        uses.emplace_back(prefixLength[v], representative[v], v);
+      }
+    }
+    std::sort(uses.begin(), uses.end());
+
+    prefix.assign(n, noPrefix);
+    prefixOffsets.assign(1, 0);
+    prefixHubs.clear();
+    for (std::size_t i = 0; i < uses.size(); ++i) {
+      const auto [length, first, v] = uses[i];
+      if (i == 0 || std::get<0>(uses[i - 1]) != length ||
+          std::get<1>(uses[i - 1]) != first) {
+        prefixHubs.insert(prefixHubs.end(), labels[first].hubs.begin(),
+                          labels[first].hubs.begin() + length);
+        prefixOffsets.push_back(prefixHubs.size());
+      }
+      prefix[v] = prefixOffsets.size() - 2;
+    }
+
+    tailOffsets.assign(n + 1, 0);
+    offsets.assign(n + 1, 0);
+    for (Vertex v = 0; v < n; ++v) {
+      tailOffsets[v + 1] = labels[v].size() - prefixLength[v];
+      offsets[v + 1] = labels[v].size();
+    }
+    parallelPrefixSum(tailOffsets, numThreads);
+    parallelPrefixSum(offsets, numThreads);
+    tailHubs.resize(tailOffsets[n]);
+    dists.resize(offsets[n]);
+    parallelForBlocks(numThreads, 0, n,
+                      [&](std::size_t, std::size_t begin, std::size_t end) {
+                        for (std::size_t v = begin; v < end; ++v) {
+                          std::copy(labels[v].hubs.begin() + prefixLength[v],
+                                    labels[v].hubs.end(),
+                                    tailHubs.begin() + tailOffsets[v]);
+                          std::copy(labels[v].dists.begin(),
+                                    labels[v].dists.end(),
+                                    dists.begin() + offsets[v]);
+                        }
+                      });
+  }
+};
+
+inline std::array<SharedPrefixLabels, 2> sharePrefixes(
+    const std::array<std::vector<Label>, 2>& labels,
+    const std::size_t numThreads = 1) {
+  StatusLog log("Sharing label prefixes");
+  return {SharedPrefixLabels(labels[FWD], numThreads),
+          SharedPrefixLabels(labels[BWD], numThreads)};
+}
+
+// The prefix of a label only has hubs below its tail, so each side consists of
+// two sorted runs. Pairs of runs whose hub ranges do not overlap are skipped.
+inline Distance query(const SharedPrefixLabels& fwdLabels, const Vertex from,
+                      const SharedPrefixLabels& bwdLabels, const Vertex to) {
+  const std::array<LabelView, 2> left{fwdLabels.prefixOf(from),
+                                      fwdLabels.tailOf(from)};
+  const std::array<LabelView, 2> right{bwdLabels.prefixOf(to),
+                                       bwdLabels.tailOf(to)};
+
+  Distance result = infinity;
+  for (const LabelView& l : left) {
+    if (l.size == 0) continue;
+    for (const LabelView& r : right) {
+      if (r.size == 0 || l.hubs[l.size - 1] < r.hubs[0] ||
+          r.hubs[r.size - 1] < l.hubs[0]) {
+        continue;
+      }
+      result = std::min(result, minDistance(l, r, result));
+    }
+  }
+  return result;
+}
+
+inline Distance query(const std::array<SharedPrefixLabels, 2>& labels,
+                      const Vertex from, const Vertex to) {
+  return query(labels[FWD], from, labels[BWD], to);
+}
+
+// Reports the dictionary, the size compared to the frozen (CSR) labels, and
+// the query time on both for the same random queries.
+inline void showSharedPrefixStats(
+    const std::array<SharedPrefixLabels, 2>& labels,
+    const std::array<FrozenLabels, 2>& frozen, const std::size_t numQueries) {
+  std::size_t sharedBytes = 0, numPrefixes = 0, prefixEntries = 0;
+  std::size_t numEntries = 0, numSharing = 0;
+  for (const SharedPrefixLabels& labelSet : labels) {
+    sharedBytes += labelSet.computeTotalBytes();
+    numPrefixes += labelSet.numPrefixes();
+    prefixEntries += labelSet.prefixHubs.size();
+    numEntries += labelSet.prefixHubs.size() + labelSet.tailHubs.size();
+    numSharing += std::count_if(labelSet.prefix.begin(), labelSet.prefix.end(),
+                                [](const std::uint32_t p) {
+                                  return p != SharedPrefixLabels::noPrefix;
+                                });
+  }
+  const std::size_t frozenBytes =
+      frozen[FWD].computeTotalBytes() + frozen[BWD].computeTotalBytes();
+
+  std::cout << "Shared prefix labels:" << std::endl;
+  std::cout << "  Prefixes:     " << numPrefixes << " (" << prefixEntries
+            << " entries, used by " << numSharing << " labels)" << std::endl;
+  std::cout << "  Stored hubs:  " << numEntries << " of "
+            << frozen[FWD].numEntries() + frozen[BWD].numEntries()
+            << std::endl;
+  std::cout << "  Megabytes:    "
+            << static_cast<double>(sharedBytes / (1024.0 * 1024.0))
+            << std::endl;
+  std::cout << "  Ratio vs CSR: "
+            << static_cast<double>(frozenBytes) /
+                   std::max<std::size_t>(sharedBytes, 1)
+            << std::endl;
+
+  if (numQueries == 0) return;
+  const double plainTime =
+      benchmarkQueries(frozen[FWD].numVertices(), numQueries,
+                       [&](const Vertex from, const Vertex to) {
+                         return query(frozen, from, to);
+                       });
+  const double sharedTime =
+      benchmarkQueries(labels[FWD].numVertices(), numQueries,
+                       [&](const Vertex from, const Vertex to) {
+                         return query(labels, from, to);
+                       });
+  std::cout << "  Query slowdown vs CSR: " << sharedTime / plainTime
+            << std::endl;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Small helpers to parse whitespace separated numbers from (memory-mapped)
+// text files without any copying.
+
+// Parses the next number in [pos, end), skipping leading blanks. On success,
+// pos is moved behind the number. Newlines are not skipped.
+template <std::integral T>
+bool parseNext(const char*& pos, const char* end, T& value) {
+  while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r')) ++pos;
+  auto result = std::from_chars(pos, end, value);
+  if (result.ec != std::errc()) return false;
+  pos = result.ptr;
+  return true;
+}
+
+// Returns true if only blanks are left in [pos, end).
+inline bool onlyBlanksLeft(const char* pos, const char* end) {
+  return std::all_of(pos, end, [](const char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  });
+}
+
+// Splits text into at most numParts consecutive parts, each consisting of
+// whole lines.
+inline std::vector<std::string_view> splitAtLines(std::string_view text,
+                                                  const std::size_t numParts) {
+  std::vector<std::string_view> parts;
+  const std::size_t partSize = (text.size() + numParts - 1) / numParts;
+
+  std::size_t start = 0;
+  while (start < text.size()) {
+    std::size_t end = std::min(start + partSize, text.size());
+    if (end < text.size()) {
+      end = text.find('\n', end - 1);
+      end = (end == std::string_view::npos) ? text.size() : end + 1;
+    }
+    parts.push_back(text.substr(start, end - start));
+    start = end;
+  }
+  return parts;
+}
+
+// Calls parseLine(line) for every non-empty line of text. The line does not
+// contain the trailing newline.
+template <typename FUNC>
+void forEachLine(std::string_view text, FUNC&& parseLine) {
+  std::size_t start = 0;
+  while (start < text.size()) {
+    std::size_t end = text.find('\n', start);
+    if (end == std::string_view::npos) end = text.size();
+    if (end > start) parseLine(text.substr(start, end - start));
+    start = end + 1;
+  }
+}
+
+// Splits text at line boundaries and calls parseLine(threadId, line) for every
+// non-empty line, using numThreads threads. The lines of one thread are
+// consecutive in the text and are processed in order.
+template <typename FUNC>
+void parseLinesInParallel(std::string_view text, const std::size_t numThreads,
+                          FUNC&& parseLine) {
+  const std::vector<std::string_view> parts = splitAtLines(text, numThreads);
+  std::vector<std::thread> workers;
+
+  for (std::size_t t = 0; t < parts.size(); ++t) {
+    workers.emplace_back([&, t]() {
+      forEachLine(parts[t],
+                  [&](std::string_view line) { parseLine(t, line); });
+    });
+  }
+  for (auto& thread : workers) thread.join();
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "../external/timer.h"
+
+// A fixed set of worker threads which is reused for every parallel phase, so
+// the threads are not created and joined again for every round. The calling
+// thread takes part in the work as thread 0; every call returns only after
+// all threads have finished (i.e. it ends with a barrier).
+class ThreadPool {
+ public:
+  explicit ThreadPool(const std::size_t numThreads = 1)
+      : numThreads(std::max<std::size_t>(numThreads, 1)),
+        busyMicros(this->numThreads, 0) {
+    workers.reserve(this->numThreads - 1);
+    for (std::size_t t = 1; t < this->numThreads; ++t) {
+      workers.emplace_back([this, t]() { workerLoop(t); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() {
+    stop = true;
+    generation.fetch_add(1);
+    generation.notify_all();
+    for (auto& thread : workers) thread.join();
+  }
+
+  std::size_t size() const { return numThreads; }
+
+  // Time in microseconds every thread spent working on jobs since the last
+  // resetBusyTime(); the difference between the threads shows the imbalance.
+  const std::vector<long long>& busyTime() const { return busyMicros; }
+  void resetBusyTime() { std::fill(busyMicros.begin(), busyMicros.end(), 0); }
+
+  // Calls func(threadId) once on every thread.
+  template <typename FUNC>
+  void run(FUNC&& func) {
+    if (numThreads == 1) {
+      timed(0, func);
+      return;
+    }
+
+    job = const_cast<void*>(static_cast<const void*>(std::addressof(func)));
+    invoke = [](void* context, const std::size_t threadId) {
+      (*static_cast<std::remove_reference_t<FUNC>*>(context))(threadId);
+    };
+    running = numThreads - 1;
+
+    // publishes the job and wakes up the workers
+    generation.fetch_add(1);
+    generation.notify_all();
+
+    timed(0, func);
+
+    for (std::size_t left = running; left != 0; left = running) {
+      running.wait(left);
+    }
+  }
+
+  // Splits [begin, end) into one block per thread, like parallelForBlocks, and
+  // calls func(threadId, blockBegin, blockEnd).
+  template <typename FUNC>
+  void forBlocks(const std::size_t begin, const std::size_t end, FUNC&& func) {
+    const std::size_t chunkSize = (end - begin + numThreads - 1) / numThreads;
+    run([&](const std::size_t t) {
+      const std::size_t blockBegin = std::min(begin + t * chunkSize, end);
+      const std::size_t blockEnd = std::min(blockBegin + chunkSize, end);
+      func(t, blockBegin, blockEnd);
+    });
+  }
+
+  // Calls func(threadId, task) for every task in [0, numTasks). The threads
+  // claim the tasks one after another, so a thread that finishes early helps
+  // with the remaining ones.
+  template <typename FUNC>
+  void forTasks(const std::size_t numTasks, FUNC&& func) {
+    std::atomic<std::size_t> nextTask = 0;
+    run([&](const std::size_t t) {
+      for (std::size_t task = nextTask.fetch_add(1); task < numTasks;
+           task = nextTask.fetch_add(1)) {
+        func(t, task);
+      }
+    });
+  }
+
+ private:
+  template <typename FUNC>
+  void timed(const std::size_t threadId, FUNC&& func) {
+    const long long start = get_micro_time();
+    func(threadId);
+    busyMicros[threadId] += get_micro_time() - start;
+  }
+
+  void workerLoop(const std::size_t threadId) {
+    std::size_t seenGeneration = 0;
+    while (true) {
+      generation.wait(seenGeneration);
+      seenGeneration = generation;
+      if (stop) return;
+
+      timed(threadId, [&](const std::size_t t) { invoke(job, t); });
+
+      if (running.fetch_sub(1) == 1) running.notify_one();
+    }
+  }
+
+  std::size_t numThreads;
+  std::vector<std::thread> workers;
+  std::vector<long long> busyMicros;
+
+  // the job is only written while all workers are waiting for the next
+  // generation, and it is published by incrementing the generation
+  void* job = nullptr;
+  void (*invoke)(void*, std::size_t) = nullptr;
+  std::atomic<std::size_t> running = 0;
+  std::atomic<std::size_t> generation = 0;
+  std::atomic<bool> stop = false;
+};
+
+inline void showBusyTime(const std::vector<long long>& busyMicros) {
+  if (busyMicros.empty()) return;
+
+  const long long maxTime =
+      *std::max_element(busyMicros.begin(), busyMicros.end());
+  const double avgTime =
+      std::accumulate(busyMicros.begin(), busyMicros.end(), 0.0) /
+      busyMicros.size();
+
+  std::cout << "Thread busy time [ms]:" << std::endl;
+  for (std::size_t t = 0; t < busyMicros.size(); ++t) {
+    std::cout << "  Thread " << t << ":     " << busyMicros[t] / 1000
+              << std::endl;
+  }
+  std::cout << "  Max / Avg:    " << (avgTime > 0 ? maxTime / avgTime : 1.0)
+            << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,198 @@
+#pragma once
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "../external/status_log.h"
+#include "frozen_labels.h"
+#include "hub_labels.h"
+#include "intersection.h"
+#include "types.h"
+#include "utils.h"
+
+// Minimum of left[i] + right[i] over two rows of width distances, where width
+// is a multiple of rowAlignment. Both rows hold infinity for missing hubs, so
+// the sums never exceed 2 * infinity and fit into a byte.
+inline Distance minDistanceDense(const Distance* left, const Distance* right,
+                                 const std::size_t width) {
+#ifdef __AVX2__
+  __m256i best = _mm256_set1_epi8(static_cast<char>(infinity));
+  for (std::size_t i = 0; i < width; i += 32) {
+    const __m256i l =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + i));
+    const __m256i r =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + i));
+    best = _mm256_min_epu8(best, _mm256_adds_epu8(l, r));
+  }
+  __m128i minimum = _mm_min_epu8(_mm256_castsi256_si128(best),
+                                 _mm256_extracti128_si256(best, 1));
+  minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 8));
+  minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 4));
+  minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 2));
+  minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 1));
+  return static_cast<Distance>(_mm_cvtsi128_si32(minimum) & 0xFF);
+#else
+  Distance best = infinity;
+  for (std::size_t i = 0; i < width; ++i) {
+    best = std::min<Distance>(best, left[i] + right[i]);
+  }
+  return best;
+#endif
+}
+
+// Labels of one direction split at the top ranked hubs. Queries mostly meet at
+// one of the highest ranked vertices, i.e. the smallest hub ids, which open
+// almost every label. The distances to the hubs [0, numTopHubs) are therefore
+// stored in one fixed-width row per vertex (infinity if the hub is missing),
+// and only the remaining hubs stay in a sorted tail (CSR as in FrozenLabels).
+// A query takes the vectorized minimum over both rows and then merges the
+// tails with the row minimum as cutoff.
+struct TopHubLabels {
+  // rows are padded to whole cache lines, which are a multiple of the SIMD
+  // width
+  static constexpr std::size_t rowAlignment = 64;
+
+  std::size_t numTopHubs = 0;
+  std::size_t rowWidth = 0;
+  std::vector<Distance> rows;
+
+  std::vector<std::size_t> tailOffsets;
+  std::vector<Vertex> tailHubs;
+  std::vector<Distance> tailDists;
+
+  TopHubLabels() : tailOffsets(1, 0) {}
+
+  TopHubLabels(const std::vector<Label>& labels, const std::size_t numTopHubs,
+               const std::size_t numThreads = 1)
+      : TopHubLabels() {
+    build(labels, numTopHubs, numThreads);
+  }
+
+  std::size_t numVertices() const { return tailOffsets.size() - 1; }
+  std::size_t numTailEntries() const { return tailHubs.size(); }
+
+  const Distance* rowOf(const Vertex v) const {
+    assert(v < numVertices());
+    return rows.data() + v * rowWidth;
+  }
+
+  LabelView tailOf(const Vertex v) const {
+    assert(v < numVertices());
+    return LabelView(tailHubs.data() + tailOffsets[v],
+                     tailDists.data() + tailOffsets[v],
+                     tailOffsets[v + 1] - tailOffsets[v]);
+  }
+
+  std::size_t computeTotalBytes() const {
+    return sizeof(TopHubLabels) + rows.capacity() * sizeof(Distance) +
+           tailOffsets.capacity() * sizeof(std::size_t) +
+           tailHubs.capacity() * sizeof(Vertex) +
+           tailDists.capacity() * sizeof(Distance);
+  }
+
+  void build(const std::vector<Label>& labels, const std::size_t topHubs,
+             const std::size_t numThreads = 1) {
+    const std::size_t n = labels.size();
+    numTopHubs = topHubs;
+    rowWidth = (numTopHubs + rowAlignment - 1) / rowAlignment * rowAlignment;
+    rows.assign(n * rowWidth, infinity);
+
+    // the top hubs are the sorted beginning of every label
+    std::vector<std::size_t> numTop(n);
+    tailOffsets.assign(n + 1, 0);
+    parallelForBlocks(numThreads, 0, n,
+                      [&](std::size_t, std::size_t begin, std::size_t end) {
+                        for (std::size_t v = begin; v < end; ++v) {
+                          const auto& hubs = labels[v].hubs;
+                          numTop[v] = std::lower_bound(hubs.begin(), hubs.end(),
+                                                       Vertex(numTopHubs)) -
+                                      hubs.begin();
+                          tailOffsets[v + 1] = hubs.size() - numTop[v];
+                        }
+                      });
+    parallelPrefixSum(tailOffsets, numThreads);
+
+    tailHubs.resize(tailOffsets[n]);
+    tailDists.resize(tailOffsets[n]);
+    parallelForBlocks(
+        numThreads, 0, n,
+        [&](std::size_t, std::size_t begin, std::size_t end) {
+          for (std::size_t v = begin; v < end; ++v) {
+            const Label& label = labels[v];
+            Distance* row = rows.data() + v * rowWidth;
+            for (std::size_t i = 0; i < numTop[v]; ++i) {
+              row[label.hubs[i]] =
+                  std::min(row[label.hubs[i]], label.dists[i]);
+            }
+            std::copy(label.hubs.begin() + numTop[v], label.hubs.end(),
+                      tailHubs.begin() + tailOffsets[v]);
+            std::copy(label.dists.begin() + numTop[v], label.dists.end(),
+                      tailDists.begin() + tailOffsets[v]);
+          }
+        });
+  }
+};
+
+inline std::array<TopHubLabels, 2> splitTopHubs(
+    const std::array<std::vector<Label>, 2>& labels,
+    const std::size_t numTopHubs, const std::size_t numThreads = 1) {
+  StatusLog log("Building top hub tables");
+  return {TopHubLabels(labels[FWD], numTopHubs, numThreads),
+          TopHubLabels(labels[BWD], numTopHubs, numThreads)};
+}
+
+inline Distance query(const TopHubLabels& fwdLabels, const Vertex from,
+                      const TopHubLabels& bwdLabels, const Vertex to) {
+  assert(fwdLabels.rowWidth == bwdLabels.rowWidth);
+  const Distance top = minDistanceDense(
+      fwdLabels.rowOf(from), bwdLabels.rowOf(to), fwdLabels.rowWidth);
+  return std::min(top, minDistance(fwdLabels.tailOf(from),
+                                   bwdLabels.tailOf(to), top));
+}
+
+inline Distance query(const std::array<TopHubLabels, 2>& labels,
+                      const Vertex from, const Vertex to) {
+  return query(labels[FWD], from, labels[BWD], to);
+}
+
+inline void benchmark_hublabels(const std::array<TopHubLabels, 2>& labels,
+                                const std::size_t numQueries) {
+  benchmarkQueries(labels[FWD].numVertices(), numQueries,
+                   [&](const Vertex from, const Vertex to) {
+                     return query(labels, from, to);
+                   });
+}
+
+// Reports how many label entries moved into the rows and the size compared to
+// the frozen (CSR) labels.
+inline void showTopHubStats(const std::array<TopHubLabels, 2>& labels,
+                            const std::array<FrozenLabels, 2>& frozen) {
+  std::size_t topBytes = 0, tailEntries = 0, numEntries = 0;
+  for (const DIRECTION dir : {FWD, BWD}) {
+    topBytes += labels[dir].computeTotalBytes();
+    tailEntries += labels[dir].numTailEntries();
+    numEntries += frozen[dir].numEntries();
+  }
+  const std::size_t frozenBytes =
+      frozen[FWD].computeTotalBytes() + frozen[BWD].computeTotalBytes();
+
+  std::cout << "Top hub labels (" << labels[FWD].numTopHubs
+            << " hubs, rows of " << labels[FWD].rowWidth
+            << " bytes):" << std::endl;
+  std::cout << "  Entries in rows: " << numEntries - tailEntries << " of "
+            << numEntries << std::endl;
+  std::cout << "  Megabytes:       "
+            << static_cast<double>(topBytes / (1024.0 * 1024.0)) << std::endl;
+  std::cout << "  Ratio vs CSR:    "
+            << static_cast<double>(frozenBytes) /
+                   std::max<std::size_t>(topBytes, 1)
+            << std::endl;
+}
@@ -4,12 +4,16 @@
 #include <atomic>
 #include <bit>
 #include <bitset>
+#include <charconv>
 #include <concepts>
 #include <iostream>
 #include <limits>
 #include <memory>
 #include <numeric>
+#include <ostream>
 #include <random>
+#include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -169,6 +173,161 @@ std::vector<std::pair<VALUE, VALUE>> generateRandomQueries(int numQueries,
   return queries;
 }
 
+// Splits [begin, end) into numThreads consecutive blocks of (almost) equal size
+// and calls func(threadId, blockBegin, blockEnd) for every block, each in its
+// own thread.
+template <typename FUNC>
+void parallelForBlocks(const std::size_t numThreads, const std::size_t begin,
+                       const std::size_t end, FUNC &&func) {
+  const std::size_t chunkSize = (end - begin + numThreads - 1) / numThreads;
+  std::vector<std::thread> workers;
+
+  for (std::size_t t = 0; t < numThreads; ++t) {
+    workers.emplace_back([&, t]() {
+      const std::size_t blockBegin = std::min(begin + t * chunkSize, end);
+      const std::size_t blockEnd = std::min(blockBegin + chunkSize, end);
+      func(t, blockBegin, blockEnd);
+    });
+  }
+  for (auto &thread : workers) thread.join();
+}
+
+// Replaces every element of values by the sum of itself and all its
+// predecessors (inclusive prefix sum). Every thread sums up one block, the
+// block sums are combined sequentially, and then every thread adds the sum of
+// all previous blocks to its own block.
+template <typename T>
+void parallelPrefixSum(std::vector<T> &values, const std::size_t numThreads) {
+  std::vector<T> blockSums(numThreads, T(0));
+
+  parallelForBlocks(numThreads, 0, values.size(),
+                    [&](const std::size_t t, const std::size_t begin,
+                        const std::size_t end) {
+                      for (std::size_t i = begin + 1; i < end; ++i) {
+                        values[i] += values[i - 1];
+                      }
+                      if (begin < end) blockSums[t] = values[end - 1];
+                    });
+
+  std::exclusive_scan(blockSums.begin(), blockSums.end(), blockSums.begin(),
+                      T(0));
+
+  parallelForBlocks(numThreads, 0, values.size(),
+                    [&](const std::size_t t, const std::size_t begin,
+                        const std::size_t end) {
+                      for (std::size_t i = begin; i < end; ++i) {
+                        values[i] += blockSums[t];
+                      }
+                    });
+}
+
+// Cuts [0, numItems) into at most numChunks consecutive chunks of about the
+// same total weight(i) and returns the numChunks + 1 chunk boundaries (fewer,
+// if single items outweigh a whole chunk).
+template <typename FUNC>
+std::vector<std::size_t> balancedChunks(const std::size_t numItems,
+                                        const std::size_t numChunks,
+                                        FUNC &&weight) {
+  std::size_t totalWeight = 0;
+  for (std::size_t i = 0; i < numItems; ++i) totalWeight += weight(i);
+
+  std::vector<std::size_t> boundaries = {0};
+  if (totalWeight == 0) {
+    boundaries.push_back(numItems);
+    return boundaries;
+  }
+
+  // a chunk ends behind item i, if the prefix weight reaches a new multiple
+  // of totalWeight / numChunks
+  std::size_t prefixWeight = 0;
+  std::size_t currentChunk = 0;
+  for (std::size_t i = 0; i + 1 < numItems; ++i) {
+    prefixWeight += weight(i);
+    const std::size_t chunk = prefixWeight * numChunks / totalWeight;
+    if (chunk > currentChunk) {
+      boundaries.push_back(i + 1);
+      currentChunk = chunk;
+    }
+  }
+  boundaries.push_back(numItems);
+  return boundaries;
+}
+
+// Sorts values with numThreads threads: every thread sorts one block, then
+// neighbouring blocks are merged pairwise until one block is left.
+template <typename T, typename COMPARE>
+void parallelSort(std::vector<T> &values, const std::size_t numThreads,
+                  COMPARE &&compare) {
+  const std::size_t chunkSize =
+      (values.size() + numThreads - 1) / std::max<std::size_t>(numThreads, 1);
+  if (numThreads <= 1 || chunkSize == 0) {
+    std::sort(values.begin(), values.end(), compare);
+    return;
+  }
+
+  parallelForBlocks(numThreads, 0, values.size(),
+                    [&](std::size_t, const std::size_t begin,
+                        const std::size_t end) {
+                      std::sort(values.begin() + begin, values.begin() + end,
+                                compare);
+                    });
+
+  for (std::size_t width = chunkSize; width < values.size(); width *= 2) {
+    std::vector<std::thread> workers;
+    for (std::size_t begin = 0; begin + width < values.size();
+         begin += 2 * width) {
+      workers.emplace_back([&, begin]() {
+        const std::size_t end = std::min(begin + 2 * width, values.size());
+        std::inplace_merge(values.begin() + begin,
+                           values.begin() + begin + width,
+                           values.begin() + end, compare);
+      });
+    }
+    for (auto &thread : workers) thread.join();
+  }
+}
+
+// Appends the decimal representation of value to buffer.
+template <std::integral T>
+void appendNumber(std::string &buffer, const T value) {
+  char digits[24];
+  auto result = std::to_chars(digits, digits + sizeof(digits), value);
+  buffer.append(digits, result.ptr);
+}
+
+// Formats the items [0, numItems) in parallel and writes them to out, in order.
+// format(i, buffer) has to append the text of item i to buffer. Each thread
+// formats a block of consecutive items into its own buffer, and every block is
+// then written with a single large write.
+template <typename FUNC>
+void writeInParallel(std::ostream &out, const std::size_t numItems,
+                     const std::size_t numThreads, FUNC &&format,
+                     const std::size_t itemsPerBlock = 1 << 14) {
+  std::vector<std::string> buffers(numThreads);
+  std::vector<std::thread> workers;
+
+  for (std::size_t batchStart = 0; batchStart < numItems;
+       batchStart += numThreads * itemsPerBlock) {
+    workers.clear();
+    for (std::size_t t = 0; t < numThreads; ++t) {
+      workers.emplace_back([&, t]() {
+        const std::size_t start =
+            std::min(batchStart + t * itemsPerBlock, numItems);
+        const std::size_t end = std::min(start + itemsPerBlock, numItems);
+        buffers[t].clear();
+        for (std::size_t i = start; i < end; ++i) {
+          format(i, buffers[t]);
+        }
+      });
+    }
+    for (auto &thread : workers) thread.join();
+
+    for (const auto &buffer : buffers) {
+      out.write(buffer.data(), buffer.size());
+    }
+  }
+}
+
 template <typename T>
 bool fetch_max(std::atomic<T> &atomicValue, T newValue) {
   T oldValue = atomicValue.load();
@@ -2,22 +2,51 @@
 #include <random>
 #include <thread>
 
+#include "datastructures/binary_graph.h"
+#include "datastructures/binary_labels.h"
+#include "datastructures/compressed_labels.h"
+#include "datastructures/frozen_labels.h"
 #include "datastructures/graph.h"
 #include "datastructures/hub_labels.h"
+#include "datastructures/label_layout.h"
 #include "datastructures/psl.h"
 #include "datastructures/psl_plus.h"
 #include "datastructures/psl_star.h"
+#include "datastructures/ranking.h"
+#include "datastructures/shared_prefix_labels.h"
+#include "datastructures/thread_pool.h"
+#include "datastructures/top_hub_labels.h"
 #include "external/cmdparser.hpp"
 
 void configure_parser(cli::Parser &parser) {
-  parser.set_required<std::string>("i", "input_graph",
+  parser.set_optional<std::string>("i", "input_graph", "",
                                    "Input graph file (in DIMACS format).");
+  parser.set_optional<std::string>(
+      "g", "graph_cache", "",
+      "Binary graph cache to read the reordered graph from, instead of the "
+      "DIMACS input graph. It already holds the ordering, so -k, -l and -w "
+      "cannot be used with it.");
+  parser.set_optional<std::string>(
+      "w", "write_graph_cache", "",
+      "Writes the reordered graph, its reverse graph and the rank into a "
+      "binary graph cache.");
+  parser.set_optional<std::string>(
+      "k", "ordering", "degree",
+      "Vertex ordering: degree, product (in- times out-degree), coverage "
+      "(sampled shortest paths) or file (see -l).");
+  parser.set_optional<std::string>(
+      "l", "rank_file", "",
+      "File with one vertex id per line, from the most to the least important "
+      "vertex. Used with the ordering 'file'.");
   parser.set_optional<std::size_t>(
       "t", "number_threads",
       static_cast<std::size_t>(std::thread::hardware_concurrency()),
       "Number of threads to use.");
   parser.set_optional<std::string>("o", "output_file", "",
                                    "Output file to save hub labels into.");
+  parser.set_optional<std::string>(
+      "b", "binary_output_file", "",
+      "Output file to save hub labels into, using the binary format.");
   parser.set_optional<bool>(
       "s", "show_stats", false,
       "Show statistics about the graph, as well as the computed hub labels.");
@@ -27,6 +56,45 @@ void configure_parser(cli::Parser &parser) {
       "file is passed as argument, the mapping function f(v) will be exported "
       "as well.");
   parser.set_optional<bool>("r", "PSL*", false, "Uses the PSL* algorithm.");
+  parser.set_optional<bool>(
+      "d", "dense_lookup", false,
+      "Tests the candidates against a dense per-thread distance array "
+      "instead of merging labels. Needs number_threads * |V| bytes.");
+  parser.set_optional<std::string>(
+      "m", "round_mode", "auto",
+      "How the construction rounds find the candidates: pull, push or auto "
+      "(picks the cheaper one in every round).");
+  parser.set_optional<double>(
+      "y", "tail_yield", 0,
+      "Once a PSL round adds fewer new entries per processed vertex, the "
+      "remaining labels are computed with pruned searches (0 disables it).");
+  parser.set_optional<std::size_t>(
+      "x", "bit_parallel_roots", 0,
+      "Number of bit-parallel roots (with up to 64 neighbours each) for PSL. "
+      "Their labels are written to <output_file>.bp and into the binary "
+      "output file.");
+  parser.set_optional<std::size_t>(
+      "q", "number_queries", 0,
+      "Number of random queries to benchmark on the frozen labels.");
+  parser.set_optional<bool>(
+      "c", "compress", false,
+      "Compresses the labels (delta-encoded hubs, packed distances), shows "
+      "their size and also benchmarks the queries on them.");
+  parser.set_optional<bool>(
+      "u", "share_prefixes", false,
+      "Stores common hub prefixes of the labels once in a shared "
+      "dictionary, shows the compression ratio and, with -q, the query "
+      "slowdown against the frozen labels.");
+  parser.set_optional<std::size_t>(
+      "K", "top_hubs", 0,
+      "Stores the distances to this many highest ranked hubs (e.g. 64 to "
+      "256) in a dense row per vertex and only the other hubs in sorted "
+      "labels, shows their size and, with -q, benchmarks the queries on them "
+      "(0 disables it).");
+  parser.set_optional<bool>(
+      "L", "layout", false,
+      "Lays out the frozen labels in BFS order of the graph and compares the "
+      "query times against the vertex order (with -q).");
 };
 
 int main(int argc, char *argv[]) {
@@ -39,72 +107,200 @@ int main(int argc, char *argv[]) {
   parser.run_and_exit_if_error();
 
   const std::string inputFileName = parser.get<std::string>("i");
+  const std::string graphCacheFileName = parser.get<std::string>("g");
+  const std::string writeGraphCacheFileName = parser.get<std::string>("w");
+  const ORDERING ordering = parseOrdering(parser.get<std::string>("k"));
+  const std::string rankFileName = parser.get<std::string>("l");
   const std::size_t numberOfThreads = parser.get<std::size_t>("t");
   const std::string outputFileName = parser.get<std::string>("o");
+  const std::string binaryOutputFileName = parser.get<std::string>("b");
   const bool printStats = parser.get<bool>("s");
   const bool pslPlus = parser.get<bool>("p");
   const bool pslStar = parser.get<bool>("r");
+  const bool denseLookup = parser.get<bool>("d");
+  const double tailYield = parser.get<double>("y");
+  const ROUND_MODE roundMode = parseRoundMode(parser.get<std::string>("m"));
+  const std::size_t numberOfBitParallelRoots = parser.get<std::size_t>("x");
+  const std::size_t numberOfQueries = parser.get<std::size_t>("q");
+  const bool compressLabels = parser.get<bool>("c");
+  const bool sharePrefixLabels = parser.get<bool>("u");
+  const std::size_t numberOfTopHubs = parser.get<std::size_t>("K");
+  const bool layOutLabels = parser.get<bool>("L");
 
-  Graph g;
-  // g.readFromEdgeList(inputFileName);
-  g.readDimacs(inputFileName);
+  if (inputFileName.empty() == graphCacheFileName.empty()) {
+    std::cerr << "Error: Pass either an input graph (-i) or a binary graph "
+                 "cache (-g).\n";
+    return 1;
+  }
 
-  if (printStats) g.showStats();
+  // the graph cache already holds the reordered graph and its rank
+  if (!graphCacheFileName.empty() &&
+      (parser.get<std::string>("k") != "degree" || !rankFileName.empty() ||
+       !writeGraphCacheFileName.empty())) {
+    std::cerr << "Error: The ordering (-k, -l) and -w cannot be combined with "
+                 "a binary graph cache (-g).\n";
+    return 1;
+  }
 
-  // generate degree based rank
-  std::vector<std::size_t> rank(g.numVertices());
-  std::iota(rank.begin(), rank.end(), 0);
+  if (pslStar && numberOfBitParallelRoots > 0) {
+    std::cerr << "Error: Bit-parallel roots (-x) are only supported by PSL.\n";
+    return 1;
+  }
 
-  std::vector<std::size_t> randomNumber(g.numVertices());
-  std::iota(randomNumber.begin(), randomNumber.end(), 0);
+  Graph g;
+  Graph bwdGraph;
+  bool hasBwdGraph = false;
+  std::vector<std::size_t> rank;
 
-  std::mt19937 randomGenerator(42);
-  std::shuffle(randomNumber.begin(), randomNumber.end(), randomGenerator);
+  if (!graphCacheFileName.empty()) {
+    hasBwdGraph = loadGraphFromBinaryFile(graphCacheFileName, g, bwdGraph,
+                                          rank, numberOfThreads);
 
-  std::vector<std::size_t> degree(g.numVertices(), 0);
-  g.doForAllEdges([&](const Vertex from, const Vertex to) {
-    degree[from]++;
-    degree[to]++;
-  });
+    if (printStats) g.showStats();
+  } else {
+    // g.readFromEdgeList(inputFileName);
+    g.readDimacs(inputFileName, numberOfThreads);
 
-  std::sort(rank.begin(), rank.end(),
-            [&](const std::size_t left, const std::size_t right) {
-              return std::forward_as_tuple(degree[left], randomNumber[left]) >
-                     std::forward_as_tuple(degree[right], randomNumber[right]);
-            });
+    if (printStats) g.showStats();
 
-  g.reorderByRank(rank);
+    rank = computeRank(g, ordering, numberOfThreads, rankFileName);
+    g.reorderByRank(rank, numberOfThreads);
+
+    if (!writeGraphCacheFileName.empty()) {
+      bwdGraph = g.reverseGraph(numberOfThreads);
+      hasBwdGraph = true;
+      saveGraphToBinaryFile(g, &bwdGraph, rank, writeGraphCacheFileName);
+    }
+  }
 
   std::vector<Vertex> f;
   std::vector<Vertex> oldToNew;
   std::vector<std::uint8_t> p;
 
+  // shared by the graph reduction and the label construction
+  ThreadPool pool(numberOfThreads);
+
   if (pslPlus) {
-    auto [partition, mapping] = computePartitionAndF(g, numberOfThreads);
+    auto [partition, mapping] = computePartitionAndF(g, pool);
 
-    oldToNew = g.removeVertices(partition, mapping);
+    oldToNew = g.removeVertices(partition, mapping, numberOfThreads);
     f = mapping;
     p = partition;
 
+    // the cached reverse graph belongs to the unreduced graph
+    hasBwdGraph = false;
+
     if (printStats) g.showStats();
   }
 
-  Graph bwdGraph = g.reverseGraph();
+  if (!hasBwdGraph) bwdGraph = g.reverseGraph(numberOfThreads);
 
   auto run = [&](auto &pslData) {
+    pslData.denseLookup = denseLookup;
     pslData.run();
 
     if (printStats) pslData.showStats();
 
-    if (!outputFileName.empty())
-      saveToFile(pslData.labels, f, p, oldToNew, outputFileName);
+    // the labels of PSL are only complete with its bit-parallel labels
+    const auto *bitParallelLabels = [&]() {
+      if constexpr (requires { pslData.bitParallelLabels; }) {
+        return pslData.bitParallelLabels[FWD].empty()
+                   ? nullptr
+                   : &pslData.bitParallelLabels;
+      } else {
+        return static_cast<
+            const std::array<BitParallelTable<std::uint64_t>, 2> *>(nullptr);
+      }
+    }();
+
+    if (!outputFileName.empty()) {
+      saveToFile(pslData.labels, f, p, oldToNew, outputFileName,
+                 numberOfThreads);
+      if (bitParallelLabels)
+        saveToFile(*bitParallelLabels, outputFileName + ".bp",
+                   numberOfThreads);
+    }
+
+    if (!binaryOutputFileName.empty() || numberOfQueries > 0) {
+      auto frozen = freeze(pslData.labels, numberOfThreads);
+
+      if (!binaryOutputFileName.empty())
+        saveToBinaryFile(frozen, f, p, oldToNew, binaryOutputFileName,
+                         bitParallelLabels
+                             ? *bitParallelLabels
+                             : std::array<BitParallelTable<std::uint64_t>,
+                                          2>{});
+
+      if (numberOfQueries > 0) {
+        if (bitParallelLabels)
+          benchmark_hublabels(frozen, *bitParallelLabels, numberOfQueries);
+        else
+          benchmark_hublabels(frozen, numberOfQueries);
+
+        if (layOutLabels) {
+          benchmarkLayout(frozen,
+                          layOutInBFSOrder(frozen, g, bwdGraph,
+                                           numberOfThreads),
+                          g, bwdGraph, numberOfQueries);
+        }
+      }
+    }
+
+    if (compressLabels) {
+      auto compressed = compress(pslData.labels, numberOfThreads);
+      showCompressedStats(compressed);
+
+      if (numberOfQueries > 0) {
+        if (bitParallelLabels) {
+          benchmarkQueries(
+              compressed[FWD].numVertices(), numberOfQueries,
+              [&](const Vertex from, const Vertex to) {
+                return std::min(
+                    bitParallelDistance(*bitParallelLabels, from, to),
+                    query(compressed, from, to));
+              });
+        } else {
+          benchmark_hublabels(compressed, numberOfQueries);
+        }
+      }
+    }
+
+    if (sharePrefixLabels) {
+      showSharedPrefixStats(sharePrefixes(pslData.labels, numberOfThreads),
+                            freeze(pslData.labels, numberOfThreads),
+                            numberOfQueries);
+    }
+
+    if (numberOfTopHubs > 0) {
+      auto topHubLabels =
+          splitTopHubs(pslData.labels, numberOfTopHubs, numberOfThreads);
+      showTopHubStats(topHubLabels, freeze(pslData.labels, numberOfThreads));
+
+      if (numberOfQueries > 0) {
+        if (bitParallelLabels) {
+          benchmarkQueries(
+              topHubLabels[FWD].numVertices(), numberOfQueries,
+              [&](const Vertex from, const Vertex to) {
+                return std::min(
+                    bitParallelDistance(*bitParallelLabels, from, to),
+                    query(topHubLabels, from, to));
+              });
+        } else {
+          benchmark_hublabels(topHubLabels, numberOfQueries);
+        }
+      }
+    }
   };
 
   if (pslStar) {
-    PSLStar psl(&g, &bwdGraph, numberOfThreads);
+    PSLStar psl(&g, &bwdGraph, pool);
+    psl.roundMode = roundMode;
     run(psl);
   } else {
-    PSL psl(&g, &bwdGraph, numberOfThreads);
+    PSL psl(&g, &bwdGraph, pool);
+    psl.tailYield = tailYield;
+    psl.roundMode = roundMode;
+    psl.numBitParallelRoots = numberOfBitParallelRoots;
     run(psl);
   }
-}
+}
\ No newline at end of file
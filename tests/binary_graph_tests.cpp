@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../datastructures/binary_graph.h"
+
+class BinaryGraphTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    fwdGraph.buildFromEdges({{Edge(0, 1), Edge(0, 2), Edge(1, 2)},
+                             {Edge(2, 3), Edge(3, 0)}},
+                            4);
+    bwdGraph = fwdGraph.reverseGraph();
+    rank = {2, 0, 3, 1};
+  }
+
+  void TearDown() override { std::remove("test_graph.bin"); }
+
+  Graph fwdGraph;
+  Graph bwdGraph;
+  std::vector<std::size_t> rank;
+};
+
+TEST_F(BinaryGraphTest, RoundTrip) {
+  saveGraphToBinaryFile(fwdGraph, &bwdGraph, rank, "test_graph.bin");
+
+  Graph loadedFwd;
+  Graph loadedBwd;
+  std::vector<std::size_t> loadedRank;
+  const bool hasReverse = loadGraphFromBinaryFile(
+      "test_graph.bin", loadedFwd, loadedBwd, loadedRank, 2);
+
+  EXPECT_TRUE(hasReverse);
+  EXPECT_EQ(loadedFwd.adjArray, fwdGraph.adjArray);
+  EXPECT_EQ(loadedFwd.toVertex, fwdGraph.toVertex);
+  EXPECT_EQ(loadedBwd.adjArray, bwdGraph.adjArray);
+  EXPECT_EQ(loadedBwd.toVertex, bwdGraph.toVertex);
+  EXPECT_EQ(loadedRank, rank);
+}
+
+TEST_F(BinaryGraphTest, RoundTripWithoutReverseAndRank) {
+  saveGraphToBinaryFile(fwdGraph, nullptr, {}, "test_graph.bin");
+
+  Graph loadedFwd;
+  Graph loadedBwd;
+  std::vector<std::size_t> loadedRank = {42};
+  const bool hasReverse = loadGraphFromBinaryFile(
+      "test_graph.bin", loadedFwd, loadedBwd, loadedRank);
+
+  EXPECT_FALSE(hasReverse);
+  EXPECT_EQ(loadedFwd.adjArray, fwdGraph.adjArray);
+  EXPECT_EQ(loadedFwd.toVertex, fwdGraph.toVertex);
+  EXPECT_EQ(loadedBwd.numVertices(), 0);
+  EXPECT_TRUE(loadedRank.empty());
+}
+
+TEST_F(BinaryGraphTest, RejectsInvalidFiles) {
+  Graph loadedFwd;
+  Graph loadedBwd;
+  std::vector<std::size_t> loadedRank;
+
+  EXPECT_THROW(loadGraphFromBinaryFile("missing_graph.bin", loadedFwd,
+                                       loadedBwd, loadedRank),
+               std::runtime_error);
+
+  std::ofstream("test_graph.bin") << "p edge 4 5\na 1 2\n";
+  EXPECT_THROW(loadGraphFromBinaryFile("test_graph.bin", loadedFwd, loadedBwd,
+                                       loadedRank),
+               std::runtime_error);
+}
\ No newline at end of file
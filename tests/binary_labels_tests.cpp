@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <queue>
+#include <string>
+
+#include "../datastructures/binary_labels.h"
+#include "../datastructures/psl.h"
+
+class BinaryLabelsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    labels = {std::vector<Label>(3), std::vector<Label>(3)};
+    labels[FWD][0].add(0, 0);
+    labels[FWD][1].add(0, 1);
+    labels[FWD][1].add(1, 0);
+    labels[FWD][2].add(0, 2);
+    labels[FWD][2].add(2, 0);
+    labels[BWD][0].add(0, 0);
+    labels[BWD][1].add(1, 0);
+    labels[BWD][2].add(0, 1);
+    labels[BWD][2].add(1, 1);
+    labels[BWD][2].add(2, 0);
+  }
+
+  void TearDown() override { std::remove("test_labels.bin"); }
+
+  std::array<std::vector<Label>, 2> labels;
+};
+
+TEST_F(BinaryLabelsTest, RoundTrip) {
+  auto frozen = freeze(labels);
+  saveToBinaryFile(frozen, {}, {}, {}, "test_labels.bin");
+
+  MappedLabels mapped("test_labels.bin");
+
+  ASSERT_EQ(mapped.numVertices(), 3);
+  EXPECT_FALSE(mapped.hasMapping());
+
+  for (const DIRECTION dir : {FWD, BWD}) {
+    EXPECT_EQ(mapped[dir].numEntries(), frozen[dir].numEntries());
+    for (Vertex v = 0; v < 3; ++v) {
+      LabelView view = mapped[dir][v];
+      ASSERT_EQ(view.size, labels[dir][v].size());
+      for (std::size_t i = 0; i < view.size; ++i) {
+        EXPECT_EQ(view.getHub(i), labels[dir][v].getHub(i));
+        EXPECT_EQ(view.getDist(i), labels[dir][v].getDist(i));
+      }
+    }
+  }
+
+  for (Vertex s = 0; s < 3; ++s) {
+    for (Vertex t = 0; t < 3; ++t) {
+      EXPECT_EQ(query(mapped, s, t), query(labels[FWD][s], labels[BWD][t]));
+    }
+  }
+}
+
+TEST_F(BinaryLabelsTest, RoundTripWithMapping) {
+  std::vector<Vertex> f{0, 1, 1, 2};
+  std::vector<std::uint8_t> partition{3, 3, 1, 3};
+  std::vector<Vertex> oldToNew{0, 1, noVertex, 2};
+
+  saveToBinaryFile(freeze(labels), f, partition, oldToNew, "test_labels.bin");
+
+  MappedLabels mapped("test_labels.bin");
+
+  ASSERT_TRUE(mapped.hasMapping());
+  EXPECT_TRUE(std::equal(f.begin(), f.end(), mapped.f().begin(),
+                         mapped.f().end()));
+  EXPECT_TRUE(std::equal(partition.begin(), partition.end(),
+                         mapped.partition().begin(), mapped.partition().end()));
+  EXPECT_TRUE(std::equal(oldToNew.begin(), oldToNew.end(),
+                         mapped.oldToNew().begin(), mapped.oldToNew().end()));
+}
+
+TEST_F(BinaryLabelsTest, RejectsInvalidFiles) {
+  EXPECT_THROW(MappedLabels("does_not_exist.bin"), std::runtime_error);
+
+  std::ofstream file("test_labels.bin");
+  file << "V 3\no 0 0 0\ni 0 0 0\no 1 0 1 1 0\n";
+  file.close();
+
+  EXPECT_THROW(MappedLabels("test_labels.bin"), std::runtime_error);
+}
+// The labels of PSL with bit-parallel roots are pruned against them, so the
+// file must answer all queries together with its bit-parallel section.
+TEST(BinaryLabelsBitParallelTest, RoundTripMatchesBFS) {
+  std::srand(29);
+  std::vector<std::vector<Edge>> edges(1);
+  for (int i = 0; i < 900; ++i) {
+    edges[0].emplace_back(std::rand() % 300, std::rand() % 300);
+  }
+  Graph fwdGraph;
+  fwdGraph.buildFromEdges(edges, 300, 1, true);
+  Graph bwdGraph = fwdGraph.reverseGraph();
+
+  PSL psl(&fwdGraph, &bwdGraph, 2);
+  psl.numBitParallelRoots = 4;
+  psl.run();
+  saveToBinaryFile(freeze(psl.labels), {}, {}, {}, "test_bp_labels.bin",
+                   psl.bitParallelLabels);
+
+  MappedLabels mapped("test_bp_labels.bin");
+  ASSERT_TRUE(mapped.hasBitParallelLabels());
+  EXPECT_EQ(mapped.bitParallelRoots().size(),
+            psl.bitParallelLabels[FWD].numRoots());
+
+  for (Vertex s = 0; s < fwdGraph.numVertices(); s += 5) {
+    std::vector<Distance> expected(fwdGraph.numVertices(), infinity);
+    std::queue<Vertex> queue;
+    expected[s] = 0;
+    queue.push(s);
+    while (!queue.empty()) {
+      const Vertex u = queue.front();
+      queue.pop();
+      fwdGraph.relaxAllEdges(u, [&](Vertex, const Vertex v) {
+        if (expected[v] != infinity) return;
+        expected[v] = expected[u] + 1;
+        queue.push(v);
+      });
+    }
+    for (Vertex t = 0; t < fwdGraph.numVertices(); ++t) {
+      ASSERT_EQ(query(mapped, s, t), expected[t]) << s << " -> " << t;
+    }
+  }
+  std::remove("test_bp_labels.bin");
+}
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "../datastructures/candidate_set.h"
+
+TEST(CandidateSetTest, ChooseMode) {
+  EXPECT_EQ(CandidateSet::chooseMode(1000, 64),
+            CandidateSet::Mode::TIMESTAMPS);
+  EXPECT_EQ(CandidateSet::chooseMode(500000000, 128),
+            CandidateSet::Mode::HASHED);
+}
+
+TEST(CandidateSetTest, BothModesDeduplicate) {
+  constexpr std::size_t n = 100000;
+  std::mt19937 randomGenerator(7);
+
+  for (const auto mode :
+       {CandidateSet::Mode::TIMESTAMPS, CandidateSet::Mode::HASHED}) {
+    CandidateSet candidates(n, mode);
+
+    // the sets grow from a few entries until the hashed set has to switch to
+    // the bitmap
+    for (const std::size_t numValues : {5, 300, 20000, 10, 50000, 3}) {
+      candidates.clear();
+      std::set<Vertex> expected;
+      for (std::size_t i = 0; i < numValues; ++i) {
+        const Vertex v = randomGenerator() % std::min(n, 4 * numValues);
+        candidates.add(v);
+        candidates.add(v);
+        expected.insert(v);
+      }
+
+      EXPECT_EQ(candidates.size(), expected.size());
+      candidates.sort();
+      EXPECT_TRUE(std::equal(candidates.getStorage().begin(),
+                             candidates.getStorage().end(), expected.begin(),
+                             expected.end()));
+    }
+  }
+}
+
+TEST(CandidateSetTest, HashedSetDoesNotGrowWithVertices) {
+  CandidateSet candidates(100000000, CandidateSet::Mode::HASHED);
+  for (Vertex v = 0; v < 1000; ++v) candidates.add(v * 99991);
+  EXPECT_EQ(candidates.size(), 1000);
+  EXPECT_LT(candidates.reservedBytes(), 100000);
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "../datastructures/compressed_labels.h"
+
+class CompressedLabelsTest : public ::testing::Test {
+ protected:
+  // random sorted labels with gaps of all byte lengths and sizes around the
+  // block size
+  void SetUp() override {
+    std::mt19937 randomGenerator(11);
+    labels = {std::vector<Label>(60), std::vector<Label>(60)};
+    for (const DIRECTION dir : {FWD, BWD}) {
+      for (std::size_t v = 0; v < labels[dir].size(); ++v) {
+        const std::size_t size = v % 40;
+        const Vertex maxGap = Vertex(1) << (7 * (v % 4) + 5);
+        Vertex hub = randomGenerator() % 5;
+        for (std::size_t i = 0; i < size; ++i) {
+          labels[dir][v].add(hub, randomGenerator() % 16);
+          hub += 1 + randomGenerator() % maxGap;
+        }
+      }
+    }
+  }
+
+  std::array<std::vector<Label>, 2> labels;
+};
+
+TEST_F(CompressedLabelsTest, DecodesAllEntries) {
+  const auto compressed = compress(labels, 3);
+  EXPECT_EQ(compressed[FWD].distanceBits, 4);
+
+  for (const DIRECTION dir : {FWD, BWD}) {
+    ASSERT_EQ(compressed[dir].numVertices(), labels[dir].size());
+    for (Vertex v = 0; v < labels[dir].size(); ++v) {
+      std::vector<Vertex> hubs;
+      std::vector<Distance> dists;
+      compressed[dir].doForAll(v, [&](Vertex hub, Distance dist) {
+        hubs.push_back(hub);
+        dists.push_back(dist);
+      });
+      EXPECT_EQ(hubs, labels[dir][v].hubs);
+      EXPECT_EQ(dists, labels[dir][v].dists);
+    }
+  }
+}
+
+TEST_F(CompressedLabelsTest, QueryMatchesLabelQuery) {
+  // 8-bit distances
+  labels[FWD][3].dists[0] = 40;
+
+  const auto compressed = compress(labels, 2);
+  EXPECT_EQ(compressed[FWD].distanceBits, 8);
+
+  // labels with many common hubs
+  for (Vertex v = 0; v < 40; ++v) {
+    for (Vertex w = 0; w < 40; ++w) {
+      EXPECT_EQ(query(compressed, v, w),
+                query(labels[FWD][v], labels[BWD][w]))
+          << v << " -> " << w;
+    }
+  }
+
+  std::vector<Label> shared(2);
+  for (Vertex hub = 0; hub < 100; ++hub) {
+    shared[0].add(2 * hub, hub % 7);
+    shared[1].add(3 * hub, 5 - hub % 5);
+  }
+  const std::array<CompressedLabels, 2> sharedCompressed{
+      CompressedLabels(shared, 4), CompressedLabels(shared, 4)};
+  EXPECT_EQ(query(sharedCompressed, 0, 1), query(shared[0], shared[1]));
+  EXPECT_EQ(query(sharedCompressed, 1, 0), query(shared[1], shared[0]));
+}
+
+TEST_F(CompressedLabelsTest, SmallerThanFrozenLabels) {
+  const auto compressed = compress(labels);
+  const auto frozen = freeze(labels);
+  EXPECT_LT(compressed[FWD].computeTotalBytes(),
+            frozen[FWD].computeTotalBytes());
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "../datastructures/frontier.h"
+#include "../datastructures/thread_pool.h"
+
+namespace {
+std::vector<Vertex> toVector(std::span<const Vertex> vertices) {
+  return std::vector<Vertex>(vertices.begin(), vertices.end());
+}
+}  // namespace
+
+TEST(FrontierTest, CollectsSortedUniqueVertices) {
+  ThreadPool pool(3);
+  Frontier frontier(1000, pool.size());
+  EXPECT_TRUE(frontier.empty());
+
+  pool.run([&](const std::size_t t) {
+    frontier.activate(t, FWD, 7);
+    frontier.activate(t, FWD, 3 + t);
+    frontier.activate(t, BWD, 999);
+  });
+  frontier.collect(pool);
+
+  EXPECT_EQ(toVector(frontier.get(FWD)), (std::vector<Vertex>{3, 4, 5, 7}));
+  EXPECT_EQ(toVector(frontier.get(BWD)), std::vector<Vertex>{999});
+  EXPECT_FALSE(frontier.empty());
+
+  // the next collect only contains the newly activated vertices
+  frontier.activate(0, BWD, 7);
+  frontier.collect(pool);
+  EXPECT_TRUE(frontier.get(FWD).empty());
+  EXPECT_EQ(toVector(frontier.get(BWD)), std::vector<Vertex>{7});
+
+  frontier.collect(pool);
+  EXPECT_TRUE(frontier.empty());
+}
+
+TEST(FrontierTest, DenseFrontier) {
+  ThreadPool pool(4);
+  Frontier frontier(100, pool.size());
+
+  pool.forBlocks(0, 100, [&](std::size_t t, std::size_t begin,
+                             std::size_t end) {
+    for (std::size_t v = begin; v < end; ++v) {
+      if (v % 3 != 0) frontier.activate(t, BWD, 99 - v);
+    }
+  });
+  frontier.collect(pool);
+
+  std::vector<Vertex> expected;
+  for (Vertex v = 0; v < 100; ++v) {
+    if ((99 - v) % 3 != 0) expected.push_back(v);
+  }
+  EXPECT_EQ(toVector(frontier.get(BWD)), expected);
+
+  // all flags were reset
+  frontier.activate(0, BWD, 1);
+  frontier.collect(pool);
+  EXPECT_EQ(toVector(frontier.get(BWD)), std::vector<Vertex>{1});
+}
+
+TEST(PushedCandidatesTest, GroupsByVertex) {
+  ThreadPool pool(2);
+  PushedCandidates pushed(pool.size());
+
+  pool.run([&](const std::size_t t) {
+    pushed.add(t, FWD, 9, 4);
+    pushed.add(t, FWD, 2, 1);
+    pushed.add(t, FWD, 9, 3 - t);
+    pushed.add(t, BWD, 5, 0);
+  });
+  pushed.collect(pool);
+
+  ASSERT_EQ(pushed.size(FWD), 2);
+  EXPECT_EQ(pushed.vertex(FWD, 0), 2);
+  EXPECT_EQ(toVector(pushed.candidates(FWD, 0)), std::vector<Vertex>{1});
+  EXPECT_EQ(pushed.vertex(FWD, 1), 9);
+  EXPECT_EQ(toVector(pushed.candidates(FWD, 1)),
+            (std::vector<Vertex>{2, 3, 4}));
+
+  ASSERT_EQ(pushed.size(BWD), 1);
+  EXPECT_EQ(pushed.vertex(BWD, 0), 5);
+  EXPECT_EQ(toVector(pushed.candidates(BWD, 0)), std::vector<Vertex>{0});
+
+  // the candidates of the last round are dropped
+  pushed.collect(pool);
+  EXPECT_EQ(pushed.size(FWD), 0);
+  EXPECT_EQ(pushed.size(BWD), 0);
+}
+
+TEST(PushedCandidatesTest, ParseRoundMode) {
+  EXPECT_EQ(parseRoundMode("pull"), ROUND_MODE::PULL);
+  EXPECT_EQ(parseRoundMode("push"), ROUND_MODE::PUSH);
+  EXPECT_EQ(parseRoundMode("auto"), ROUND_MODE::AUTO);
+  EXPECT_THROW(parseRoundMode("both"), std::runtime_error);
+}
\ No newline at end of file
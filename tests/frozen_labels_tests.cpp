@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include "../datastructures/frozen_labels.h"
+
+TEST(FrozenLabelsTest, DefaultConstructor) {
+  FrozenLabels frozen;
+  EXPECT_EQ(frozen.numVertices(), 0);
+  EXPECT_EQ(frozen.numEntries(), 0);
+}
+
+TEST(FrozenLabelsTest, BuildFromLabels) {
+  std::vector<Label> labels(3);
+  labels[0].add(0, 0);
+  labels[1].add(0, 1);
+  labels[1].add(1, 0);
+  labels[2].add(0, 2);
+  labels[2].add(1, 1);
+  labels[2].add(2, 0);
+
+  FrozenLabels frozen(labels, 2);
+
+  ASSERT_EQ(frozen.numVertices(), 3);
+  EXPECT_EQ(frozen.numEntries(), 6);
+  EXPECT_EQ(frozen.size(0), 1);
+  EXPECT_EQ(frozen.size(1), 2);
+  EXPECT_EQ(frozen.size(2), 3);
+
+  for (Vertex v = 0; v < 3; ++v) {
+    LabelView view = frozen[v];
+    ASSERT_EQ(view.size, labels[v].size());
+    for (std::size_t i = 0; i < view.size; ++i) {
+      EXPECT_EQ(view.getHub(i), labels[v].getHub(i));
+      EXPECT_EQ(view.getDist(i), labels[v].getDist(i));
+    }
+  }
+}
+
+TEST(FrozenLabelsTest, EmptyLabels) {
+  std::vector<Label> labels(4);
+  labels[2].add(1, 3);
+
+  FrozenLabels frozen(labels, 3);
+
+  EXPECT_EQ(frozen.size(0), 0);
+  EXPECT_EQ(frozen.size(1), 0);
+  EXPECT_EQ(frozen.size(2), 1);
+  EXPECT_EQ(frozen.size(3), 0);
+  EXPECT_EQ(query(frozen[0], frozen[2]), infinity);
+}
+
+TEST(FrozenLabelsTest, QueryMatchesLabelQuery) {
+  std::array<std::vector<Label>, 2> labels{std::vector<Label>(2),
+                                           std::vector<Label>(2)};
+  labels[FWD][0].add(1, 5);
+  labels[FWD][0].add(2, 10);
+  labels[FWD][0].add(3, 20);
+  labels[BWD][1].add(1, 7);
+  labels[BWD][1].add(2, 1);
+  labels[BWD][1].add(3, 15);
+
+  auto frozen = freeze(labels);
+
+  EXPECT_EQ(query(frozen, 0, 1), query(labels[FWD][0], labels[BWD][1]));
+  EXPECT_EQ(query(frozen, 0, 1), 10 + 1);
+  EXPECT_EQ(query(frozen, 1, 0), infinity);
+}
\ No newline at end of file
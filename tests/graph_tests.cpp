@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <fstream>
+#include <numeric>
+#include <random>
 #include <string>
 
 #include "../datastructures/graph.h"
@@ -133,4 +136,105 @@ TEST_F(GraphTest, ReorderGraph) {
 
   EXPECT_EQ(graph.beginEdge(3), 4);
   EXPECT_EQ(graph.endEdge(3), 5);
+}
+
+TEST_F(GraphTest, ReadDimacsInParallel) {
+  std::string content = "c random graph\np sp 200 1000\n";
+  std::srand(7);
+  for (int i = 0; i < 1000; ++i) {
+    content += "a " + std::to_string(1 + std::rand() % 200) + " " +
+               std::to_string(1 + std::rand() % 200) + "\n";
+  }
+  writeTestFile("test_dimacs_large.txt", content);
+
+  Graph sequential;
+  sequential.readDimacs("test_dimacs_large.txt");
+  Graph parallel;
+  parallel.readDimacs("test_dimacs_large.txt", 4);
+  std::remove("test_dimacs_large.txt");
+
+  EXPECT_EQ(sequential.numVertices(), 200);
+  EXPECT_EQ(sequential.numEdges(), 1000);
+  EXPECT_EQ(parallel.adjArray, sequential.adjArray);
+  EXPECT_EQ(parallel.toVertex, sequential.toVertex);
+}
+
+TEST_F(GraphTest, ReadSnapRemovesDuplicates) {
+  writeTestFile("test_snap.txt",
+                "# comment\n"
+                "0 1\n"
+                "0 2\n"
+                "0 1\n"
+                "\n"
+                "3 0\n");
+
+  Graph graph;
+  graph.readSnap("test_snap.txt", 2);
+  std::remove("test_snap.txt");
+
+  EXPECT_EQ(graph.numVertices(), 4);
+  EXPECT_EQ(graph.numEdges(), 3);
+  EXPECT_EQ(graph.degree(0), 2);
+  EXPECT_EQ(graph.degree(3), 1);
+  EXPECT_EQ(graph.toVertex[graph.beginEdge(3)], 0);
+}
+
+TEST_F(GraphTest, ReadDimacsWithoutHeader) {
+  writeTestFile("test_dimacs_invalid.txt", "a 1 2\n");
+
+  Graph graph;
+  EXPECT_THROW(graph.readDimacs("test_dimacs_invalid.txt"),
+               std::runtime_error);
+  std::remove("test_dimacs_invalid.txt");
+}
+
+TEST_F(GraphTest, ParallelTransformations) {
+  std::srand(11);
+  std::vector<std::vector<Edge>> edges(1);
+  for (int i = 0; i < 2000; ++i) {
+    edges[0].emplace_back(std::rand() % 300, std::rand() % 300);
+  }
+  Graph graph;
+  graph.buildFromEdges(edges, 300);
+
+  std::vector<std::size_t> rank(graph.numVertices());
+  std::iota(rank.begin(), rank.end(), 0);
+  std::shuffle(rank.begin(), rank.end(), std::mt19937(3));
+
+  Graph sequential = graph;
+  sequential.reorderByRank(rank);
+  Graph parallel = graph;
+  parallel.reorderByRank(rank, 4);
+  EXPECT_EQ(parallel.adjArray, sequential.adjArray);
+  EXPECT_EQ(parallel.toVertex, sequential.toVertex);
+
+  const Graph reversed = parallel.reverseGraph(4);
+  EXPECT_EQ(reversed.adjArray, sequential.reverseGraph().adjArray);
+  EXPECT_EQ(reversed.toVertex, sequential.reverseGraph().toVertex);
+  for (Vertex v = 0; v < reversed.numVertices(); ++v) {
+    const auto begin = reversed.toVertex.begin();
+    EXPECT_TRUE(std::is_sorted(begin + reversed.beginEdge(v),
+                               begin + reversed.endEdge(v)));
+  }
+
+  parallel.flip(3);
+  parallel.flip(2);
+  EXPECT_EQ(parallel.adjArray, sequential.adjArray);
+  EXPECT_EQ(parallel.toVertex, sequential.toVertex);
+}
+
+TEST_F(GraphTest, RemoveVertices) {
+  Graph graph;
+  graph.readFromEdgeList("test_edge_list.txt");
+
+  // vertex 1 is represented by vertex 0 and gets removed
+  const std::vector<std::uint8_t> partition = {1, 1, 3, 3};
+  const std::vector<Vertex> representation = {0, 0, 2, 3};
+
+  const std::vector<Vertex> oldToNew =
+      graph.removeVertices(partition, representation, 2);
+
+  EXPECT_EQ(oldToNew, (std::vector<Vertex>{0, static_cast<Vertex>(-1), 1, 2}));
+  EXPECT_EQ(graph.adjArray, (std::vector<std::size_t>{0, 1, 2, 3}));
+  EXPECT_EQ(graph.toVertex, (std::vector<Vertex>{1, 2, 0}));
 }
\ No newline at end of file
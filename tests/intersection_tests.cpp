@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <vector>
+
+#include "../datastructures/intersection.h"
+
+struct TestLabel {
+  std::vector<Vertex> hubs;
+  std::vector<Distance> dists;
+
+  TestLabel(std::size_t size, Vertex universe, std::mt19937& gen) {
+    std::uniform_int_distribution<Vertex> hubDist(0, universe - 1);
+    std::uniform_int_distribution<int> distDist(0, 20);
+    std::set<Vertex> unique;
+    while (unique.size() < size) unique.insert(hubDist(gen));
+    hubs.assign(unique.begin(), unique.end());
+    for (std::size_t i = 0; i < size; ++i) {
+      dists.push_back(static_cast<Distance>(distDist(gen)));
+    }
+  }
+
+  LabelView view() const {
+    return LabelView(hubs.data(), dists.data(), hubs.size());
+  }
+};
+
+Distance bruteForce(const LabelView& left, const LabelView& right,
+                    std::uint32_t cutoff) {
+  std::uint32_t result = infinity;
+  for (std::size_t i = 0; i < left.size; ++i) {
+    for (std::size_t j = 0; j < right.size; ++j) {
+      if (left.hubs[i] == right.hubs[j] && left.dists[i] < cutoff &&
+          right.dists[j] < cutoff) {
+        result = std::min(result, static_cast<std::uint32_t>(left.dists[i] +
+                                                             right.dists[j]));
+      }
+    }
+  }
+  return static_cast<Distance>(result);
+}
+
+TEST(IntersectionTest, EmptyLabels) {
+  LabelView empty;
+  std::vector<Vertex> hubs{1, 2, 3};
+  std::vector<Distance> dists{1, 2, 3};
+  LabelView other(hubs.data(), dists.data(), hubs.size());
+
+  EXPECT_EQ(minDistance(empty, empty), infinity);
+  EXPECT_EQ(minDistance(empty, other), infinity);
+  EXPECT_EQ(minDistance(other, empty), infinity);
+  EXPECT_EQ(minDistance(other, other), 2);
+}
+
+TEST(IntersectionTest, AllKernelsMatchBruteForce) {
+  std::mt19937 gen(42);
+  const std::vector<std::size_t> sizes{1, 7, 8, 9, 15, 16, 17, 40, 100, 600};
+
+  for (std::size_t leftSize : sizes) {
+    for (std::size_t rightSize : sizes) {
+      for (Vertex universe : {Vertex(700), Vertex(5000)}) {
+        TestLabel left(leftSize, universe, gen);
+        TestLabel right(rightSize, universe, gen);
+
+        for (std::uint32_t cutoff : {std::uint32_t(5), noCutoff}) {
+          const Distance expected =
+              bruteForce(left.view(), right.view(), cutoff);
+
+          EXPECT_EQ(minDistanceMerge(left.view(), right.view(), cutoff),
+                    expected);
+          EXPECT_EQ(minDistanceGalloping(left.view(), right.view(), cutoff),
+                    expected);
+          EXPECT_EQ(minDistanceGalloping(right.view(), left.view(), cutoff),
+                    expected);
+#ifdef __AVX2__
+          EXPECT_EQ(minDistanceAVX2(left.view(), right.view(), cutoff),
+                    expected);
+#endif
+#ifdef __AVX512F__
+          EXPECT_EQ(minDistanceAVX512(left.view(), right.view(), cutoff),
+                    expected);
+#endif
+          EXPECT_EQ(minDistance(left.view(), right.view(), cutoff), expected);
+        }
+      }
+    }
+  }
+}
+
+TEST(IntersectionTest, SubQueryRespectsCutoff) {
+  std::vector<Vertex> leftHubs{1, 2, 3};
+  std::vector<Distance> leftDists{5, 10, 13};
+  std::vector<Vertex> rightHubs{2, 3};
+  std::vector<Distance> rightDists{7, 1};
+
+  LabelView left(leftHubs.data(), leftDists.data(), leftHubs.size());
+  LabelView right(rightHubs.data(), rightDists.data(), rightHubs.size());
+
+  EXPECT_EQ(sub_query(left, right, 11), 10 + 7);
+  EXPECT_EQ(sub_query(left, right, 14), 13 + 1);
+  EXPECT_EQ(sub_query(left, right, 5), infinity);
+  EXPECT_EQ(query(left, right), 13 + 1);
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "../datastructures/label_layout.h"
+#include "../datastructures/psl.h"
+
+class LabelLayoutTest : public ::testing::Test {
+ protected:
+  // two components, and an isolated last vertex
+  void SetUp() override {
+    std::srand(21);
+    std::vector<std::vector<Edge>> edges(1);
+    for (int i = 0; i < 600; ++i) {
+      edges[0].emplace_back(std::rand() % 150, std::rand() % 150);
+      edges[0].emplace_back(150 + std::rand() % 49, 150 + std::rand() % 49);
+    }
+    fwdGraph.buildFromEdges(edges, 200, 1, true);
+    bwdGraph = fwdGraph.reverseGraph();
+  }
+
+  Graph fwdGraph;
+  Graph bwdGraph;
+};
+
+TEST_F(LabelLayoutTest, BFSOrderVisitsNeighboursFirst) {
+  const std::vector<Vertex> order = bfsOrder(fwdGraph, bwdGraph);
+  ASSERT_EQ(order.size(), fwdGraph.numVertices());
+
+  std::vector<Vertex> sorted = order;
+  std::sort(sorted.begin(), sorted.end());
+  for (Vertex v = 0; v < sorted.size(); ++v) ASSERT_EQ(sorted[v], v);
+
+  EXPECT_EQ(order[0], 0);
+  EXPECT_EQ(order.back(), 199);
+  // every vertex of a component is discovered from an earlier one
+  std::vector<std::size_t> position(order.size());
+  for (std::size_t i = 0; i < order.size(); ++i) position[order[i]] = i;
+  for (std::size_t i = 1; i < order.size(); ++i) {
+    const Vertex v = order[i];
+    if (v == 150 || v == 199) continue;
+    bool discovered = false;
+    for (const Graph* graph : {&fwdGraph, &bwdGraph}) {
+      graph->relaxAllEdges(v, [&](Vertex, const Vertex w) {
+        discovered |= position[w] < i;
+      });
+    }
+    EXPECT_TRUE(discovered) << v;
+  }
+}
+
+TEST_F(LabelLayoutTest, QueriesMatchVertexOrder) {
+  PSL psl(&fwdGraph, &bwdGraph, 2);
+  psl.run();
+  const auto frozen = freeze(psl.labels, 2);
+  const LaidOutLabels laidOut =
+      layOutInBFSOrder(frozen, fwdGraph, bwdGraph, 3);
+
+  ASSERT_EQ(laidOut.numVertices(), frozen[FWD].numVertices());
+  for (Vertex v = 0; v < laidOut.numVertices(); ++v) {
+    EXPECT_EQ(laidOut.order[laidOut.position[v]], v);
+    EXPECT_EQ(laidOut(FWD, v).size, frozen[FWD].size(v));
+    for (Vertex w = 0; w < laidOut.numVertices(); w += 3) {
+      ASSERT_EQ(query(laidOut, v, w), query(frozen, v, w)) << v << " -> " << w;
+    }
+  }
+
+  for (const auto& [from, to] :
+       generateRandomWalkQueries(fwdGraph, bwdGraph, 500)) {
+    ASSERT_LT(from, fwdGraph.numVertices());
+    ASSERT_LT(to, fwdGraph.numVertices());
+  }
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../datastructures/label_sort.h"
+
+namespace {
+
+// Sorts a label with a sorted prefix and compares it with a stable sort of
+// all entries.
+void checkSort(LabelSorter& sorter, std::vector<Vertex> hubs,
+               std::vector<Distance> dists, const std::size_t sortedPrefix) {
+  std::vector<std::pair<Vertex, Distance>> expected;
+  for (std::size_t i = 0; i < hubs.size(); ++i) {
+    expected.emplace_back(hubs[i], dists[i]);
+  }
+  std::stable_sort(expected.begin(), expected.end(),
+                   [](const auto& left, const auto& right) {
+                     return left.first < right.first;
+                   });
+
+  sorter.sort(hubs.data(), dists.data(), sortedPrefix, hubs.size());
+  for (std::size_t i = 0; i < hubs.size(); ++i) {
+    ASSERT_EQ(hubs[i], expected[i].first) << i;
+    ASSERT_EQ(dists[i], expected[i].second) << i;
+  }
+}
+
+}  // namespace
+
+TEST(LabelSorterTest, MergesBatchIntoSortedPrefix) {
+  LabelSorter sorter;
+  checkSort(sorter, {1, 4, 9, 7, 2, 10, 0}, {0, 1, 2, 3, 3, 3, 3}, 3);
+  // the batch only extends the prefix
+  checkSort(sorter, {1, 4, 9, 11, 12}, {0, 1, 2, 3, 3}, 3);
+  // everything is unsorted
+  checkSort(sorter, {5, 3, 1, 4}, {1, 2, 3, 4}, 0);
+  // equal hubs keep their order
+  checkSort(sorter, {2, 5, 5, 2}, {1, 2, 3, 4}, 2);
+}
+
+TEST(LabelSorterTest, RadixSortsLargeBatches) {
+  LabelSorter sorter;
+  std::mt19937 randomGenerator(3);
+
+  for (const std::size_t batchSize :
+       {LabelSorter::radixSortThreshold - 1, LabelSorter::radixSortThreshold,
+        std::size_t(5000)}) {
+    for (const Vertex maxHub : {Vertex(200), Vertex(70000), Vertex(-1)}) {
+      std::vector<Vertex> hubs;
+      std::vector<Distance> dists;
+      for (std::size_t i = 0; i < 300; ++i) {
+        hubs.push_back(randomGenerator() % maxHub);
+        dists.push_back(1);
+      }
+      std::sort(hubs.begin(), hubs.end());
+      for (std::size_t i = 0; i < batchSize; ++i) {
+        hubs.push_back(randomGenerator() % maxHub);
+        dists.push_back(randomGenerator() % 100);
+      }
+      checkSort(sorter, hubs, dists, 300);
+    }
+  }
+}
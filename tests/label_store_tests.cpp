@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include "../datastructures/label_store.h"
+
+TEST(LabelStoreTest, GrowsFromInlineIntoArena) {
+  LabelStore store(3, 2);
+  std::mt19937 randomGenerator(5);
+  std::map<Vertex, Distance> expected;
+
+  // crosses the inline capacity and several relocations
+  for (Vertex i = 0; i < 1000; ++i) {
+    const Vertex hub = randomGenerator() % 5000;
+    const Distance dist = randomGenerator() % 10;
+    store.add(i % 2, 1, hub, dist);
+    auto [it, inserted] = expected.emplace(hub, dist);
+    if (!inserted) it->second = std::min(it->second, dist);
+  }
+  store.sort(0, 1);
+  store.removeDuplicateHubs(1);
+
+  ASSERT_EQ(store.size(1), expected.size());
+  std::size_t i = 0;
+  store.view(1).doForAll([&](Vertex hub, Distance dist) {
+    auto it = std::next(expected.begin(), i++);
+    EXPECT_EQ(hub, it->first);
+    EXPECT_EQ(dist, it->second);
+  });
+  EXPECT_EQ(store.size(0), 0);
+  EXPECT_EQ(store.size(2), 0);
+}
+
+TEST(LabelStoreTest, AddAllKeepsLabelSorted) {
+  LabelStore store(1);
+  store.add(0, 0, 7, 0);
+  store.addAll(0, 0, std::vector<Vertex>{9, 2, 5}, 1);
+  store.addAll(0, 0, std::vector<Vertex>{8, 1, 3, 4, 6}, 2);
+
+  const LabelView view = store.view(0);
+  ASSERT_EQ(view.size, 9);
+  const std::vector<Vertex> hubs(view.hubs, view.hubs + view.size);
+  const std::vector<Distance> dists(view.dists, view.dists + view.size);
+  EXPECT_EQ(hubs, (std::vector<Vertex>{1, 2, 3, 4, 5, 6, 7, 8, 9}));
+  EXPECT_EQ(dists, (std::vector<Distance>{2, 1, 2, 2, 1, 2, 0, 2, 1}));
+
+  store.removeHubs(0, std::vector<Vertex>{1, 7});
+  EXPECT_EQ(store.view(0).size, 7);
+  EXPECT_EQ(store.view(0).getHub(0), 2);
+  EXPECT_EQ(store.view(0).getHub(5), 8);
+}
+
+TEST(LabelStoreTest, ReusesReleasedBlocks) {
+  LabelStore store(2);
+  for (Vertex hub = 0; hub < 100; ++hub) store.add(0, 0, hub, 1);
+  const LabelStore::Usage before = store.usage();
+  EXPECT_LE(before.liveBytes, before.reservedBytes);
+
+  // the block of label 0 is reused for label 1
+  store.clear(0, 0);
+  for (Vertex hub = 0; hub < 100; ++hub) store.add(0, 1, hub, 1);
+  EXPECT_EQ(store.usage().reservedBytes, before.reservedBytes);
+  EXPECT_EQ(store.size(0), 0);
+  EXPECT_EQ(store.view(1).getHub(99), 99);
+}
+
+TEST(LabelStoreTest, ExportToLabels) {
+  LabelStore store(2);
+  store.add(0, 0, 0, 0);
+  for (Vertex hub = 0; hub < 20; ++hub) store.add(0, 1, hub, hub % 3);
+
+  ThreadPool pool(2);
+  std::vector<Label> labels;
+  store.exportTo(labels, pool);
+
+  ASSERT_EQ(labels.size(), 2);
+  EXPECT_EQ(labels[0].hubs, std::vector<Vertex>{0});
+  ASSERT_EQ(labels[1].size(), 20);
+  EXPECT_EQ(labels[1].capacity(), 20);
+  EXPECT_EQ(labels[1].getDist(5), 2);
+}
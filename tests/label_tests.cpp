@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
 #include "../datastructures/hub_labels.h"
 
 TEST(LabelTest, DefaultConstructor) {
@@ -135,6 +142,115 @@ TEST(LabelTest, RemoveDuplicateHubsNoDuplicates) {
   EXPECT_EQ(label.getDist(1), 20);
 }
 
+TEST(LabelTest, AddAllKeepsLabelSorted) {
+  Label label;
+  label.add(2, 0);
+  label.add(7, 1);
+
+  const std::vector<Vertex> newHubs = {5, 1};
+  label.addAll(newHubs, 2);
+
+  const LabelView view = label.view();
+  ASSERT_EQ(view.size, 4u);
+  EXPECT_EQ(std::vector<Vertex>(view.hubs, view.hubs + view.size),
+            (std::vector<Vertex>{1, 2, 5, 7}));
+  EXPECT_EQ(std::vector<Distance>(view.dists, view.dists + view.size),
+            (std::vector<Distance>{2, 0, 2, 1}));
+}
+
+TEST(StagedHubsTest, GroupsHubsByLabel) {
+  StagedHubs staged;
+  staged.add(3);
+  staged.add(1);
+  staged.finish(FWD, 5);
+  staged.finish(BWD, 6);
+  staged.add(4);
+  staged.finish(BWD, 7);
+
+  std::vector<std::tuple<DIRECTION, Vertex, std::vector<Vertex>>> seen;
+  staged.doForAll([&](DIRECTION dir, Vertex v, std::span<const Vertex> hubs) {
+    seen.emplace_back(dir, v, std::vector<Vertex>(hubs.begin(), hubs.end()));
+  });
+
+  ASSERT_EQ(seen.size(), 2u);
+  EXPECT_EQ(seen[0],
+            std::make_tuple(FWD, Vertex(5), std::vector<Vertex>{3, 1}));
+  EXPECT_EQ(seen[1],
+            std::make_tuple(BWD, Vertex(7), std::vector<Vertex>{4}));
+
+  staged.clear();
+  EXPECT_TRUE(staged.empty());
+}
+
+TEST(RecentLevelsTest, KeepsTheNewestLevels) {
+  ThreadPool pool(2);
+  RecentLevels levels(4, pool.size(), 2);
+
+  auto stage = [&](std::size_t threadId, DIRECTION dir, Vertex v,
+                   std::vector<Vertex> hubs) {
+    for (Vertex hub : hubs) levels.next()[threadId].add(hub);
+    levels.next()[threadId].finish(dir, v);
+  };
+  auto get = [&](std::size_t age, DIRECTION dir, Vertex v) {
+    const std::span<const Vertex> hubs = levels.get(age, dir, v);
+    return std::vector<Vertex>(hubs.begin(), hubs.end());
+  };
+
+  stage(0, FWD, 1, {0});
+  stage(1, BWD, 3, {1, 2});
+  EXPECT_FALSE(levels.nextIsEmpty());
+  levels.advance(pool);
+
+  EXPECT_EQ(get(0, FWD, 1), std::vector<Vertex>{0});
+  EXPECT_EQ(get(0, BWD, 3), (std::vector<Vertex>{1, 2}));
+  EXPECT_TRUE(get(0, FWD, 3).empty());
+
+  stage(1, FWD, 2, {0, 1});
+  levels.advance(pool);
+
+  EXPECT_EQ(get(0, FWD, 2), (std::vector<Vertex>{0, 1}));
+  EXPECT_EQ(get(1, BWD, 3), (std::vector<Vertex>{1, 2}));
+  EXPECT_TRUE(levels.nextIsEmpty());
+
+  // the oldest level is dropped
+  levels.advance(pool);
+  EXPECT_TRUE(get(1, BWD, 3).empty());
+  EXPECT_EQ(get(1, FWD, 2), (std::vector<Vertex>{0, 1}));
+  EXPECT_TRUE(get(0, FWD, 2).empty());
+}
+
+TEST(LabelTest, RemoveHubs) {
+  Label label;
+  for (Vertex hub = 0; hub < 6; ++hub) label.add(hub, hub + 10);
+
+  const std::vector<Vertex> removed = {0, 3, 5};
+  label.removeHubs(removed);
+  EXPECT_EQ(label.hubs, (std::vector<Vertex>{1, 2, 4}));
+  EXPECT_EQ(label.dists, (std::vector<Distance>{11, 12, 14}));
+}
+
+TEST(ScatteredLabelTest, ReachesMatchesSubQuery) {
+  Label left, right;
+  left.add(1, 2);
+  left.add(4, 1);
+  left.add(7, 3);
+  right.add(1, 3);
+  right.add(4, 2);
+  right.add(9, 0);
+
+  ScatteredLabel scattered(10);
+  scattered.scatter(right.view());
+  EXPECT_FALSE(scattered.reaches(left.view(), 9, 2));
+  EXPECT_TRUE(scattered.reaches(left.view(), 9, 3));
+  // hub 4 is above the limit, so only hub 1 (2 + 3) is left
+  EXPECT_FALSE(scattered.reaches(left.view(), 3, 4));
+  EXPECT_TRUE(scattered.reaches(left.view(), 3, 5));
+  scattered.reset();
+
+  // the array is empty again
+  EXPECT_FALSE(scattered.reaches(left.view(), 9, 100));
+}
+
 TEST(LabelBitParallelLabelsQueryTest, SubQuery) {
   Label left, right;
   left.add(1, 5);
@@ -267,4 +383,146 @@ TEST(BitParallelLabelsQueryTest, MultipleCommonHubs) {
   right.sort();
 
   EXPECT_EQ(query(left, right), 13);
+}
+
+std::string readWholeFile(const std::string& fileName) {
+  std::ifstream file(fileName);
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+TEST(SaveToFileTest, TextFormat) {
+  std::array<std::vector<Label>, 2> labels{std::vector<Label>(2),
+                                           std::vector<Label>(2)};
+  labels[FWD][0].add(0, 0);
+  labels[BWD][0].add(0, 0);
+  labels[FWD][1].add(0, 1);
+  labels[FWD][1].add(1, 0);
+  labels[BWD][1].add(1, 0);
+
+  std::vector<Vertex> f{0, 1, 1};
+  std::vector<std::uint8_t> partition{3, 3, 1};
+  std::vector<Vertex> oldToNew{0, 1, noVertex};
+
+  saveToFile(labels, f, partition, oldToNew, "test_save.txt", 3);
+
+  EXPECT_EQ(readWholeFile("test_save.txt"),
+            "V 2\n"
+            "o 0 0 0\n"
+            "i 0 0 0\n"
+            "o 1 0 1 1 0\n"
+            "i 1 1 0\n"
+            "f 0 3 0 0\n"
+            "f 1 3 1 1\n"
+            "f 2 1 1 4294967295\n");
+  std::remove("test_save.txt");
+}
+
+TEST(SaveToFileTest, BitParallelTextFormat) {
+  std::array<std::vector<BitParallelLabels<>>, 2> labels{
+      std::vector<BitParallelLabels<>>(1), std::vector<BitParallelLabels<>>(1)};
+  labels[FWD][0].add(0, 0, 0x0F, 0xF0);
+  labels[BWD][0].add(0, 0, 0x01, 0x02);
+
+  saveToFile(labels, "test_save.txt", 2);
+
+  EXPECT_EQ(readWholeFile("test_save.txt"),
+            "V 1\n"
+            "W 8\n"
+            "o 0 0 0 15 240\n"
+            "i 0 0 0 1 2\n");
+  std::remove("test_save.txt");
+}
+
+TEST(SaveToFileTest, ParallelWriterKeepsOrder) {
+  std::ostringstream out;
+  writeInParallel(
+      out, 1000, 4,
+      [](const std::size_t i, std::string& buffer) {
+        appendNumber(buffer, i);
+        buffer += '\n';
+      },
+      7);
+
+  std::string expected;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    expected += std::to_string(i) + "\n";
+  }
+  EXPECT_EQ(out.str(), expected);
+}
+
+TEST(LoadFromFileTest, RoundTrip) {
+  std::array<std::vector<Label>, 2> labels{std::vector<Label>(50),
+                                           std::vector<Label>(50)};
+  for (Vertex v = 0; v < 50; ++v) {
+    for (Vertex h = 0; h <= v; h += 3) {
+      labels[FWD][v].add(h, static_cast<Distance>(v - h));
+      labels[BWD][v].add(h, static_cast<Distance>((v + h) % 7));
+    }
+  }
+  std::vector<Vertex> f{0, 1, 1};
+  std::vector<std::uint8_t> partition{3, 3, 1};
+  std::vector<Vertex> oldToNew{0, 1, noVertex};
+
+  saveToFile(labels, f, partition, oldToNew, "test_load.txt");
+
+  std::array<std::vector<Label>, 2> loaded;
+  std::vector<Vertex> loadedF, loadedOldToNew;
+  std::vector<std::uint8_t> loadedPartition;
+  loadFromFile(loaded, loadedF, loadedPartition, loadedOldToNew,
+               "test_load.txt", 4);
+
+  for (const DIRECTION dir : {FWD, BWD}) {
+    ASSERT_EQ(loaded[dir].size(), labels[dir].size());
+    for (Vertex v = 0; v < 50; ++v) {
+      EXPECT_EQ(loaded[dir][v].hubs, labels[dir][v].hubs);
+      EXPECT_EQ(loaded[dir][v].dists, labels[dir][v].dists);
+    }
+  }
+  EXPECT_EQ(loadedF, f);
+  EXPECT_EQ(loadedPartition, partition);
+  EXPECT_EQ(loadedOldToNew, oldToNew);
+  std::remove("test_load.txt");
+}
+
+TEST(LoadFromFileTest, BitParallelRoundTrip) {
+  std::array<std::vector<BitParallelLabels<std::uint16_t>>, 2> labels{
+      std::vector<BitParallelLabels<std::uint16_t>>(2),
+      std::vector<BitParallelLabels<std::uint16_t>>(2)};
+  labels[FWD][0].add(0, 0, 0x0F0F, 0xF0F0);
+  labels[FWD][1].add(0, 1, 0x0001, 0x0002);
+  labels[FWD][1].add(1, 0, 0x0000, 0x0000);
+  labels[BWD][1].add(1, 0, 0xFFFF, 0x0000);
+
+  saveToFile(labels, "test_load.txt");
+
+  std::array<std::vector<BitParallelLabels<std::uint16_t>>, 2> loaded;
+  loadFromFile(loaded, "test_load.txt", 2);
+
+  for (const DIRECTION dir : {FWD, BWD}) {
+    ASSERT_EQ(loaded[dir].size(), 2);
+    for (Vertex v = 0; v < 2; ++v) {
+      EXPECT_EQ(loaded[dir][v].hubs, labels[dir][v].hubs);
+      EXPECT_EQ(loaded[dir][v].dists, labels[dir][v].dists);
+      EXPECT_EQ(loaded[dir][v].bitsets_s[0], labels[dir][v].bitsets_s[0]);
+      EXPECT_EQ(loaded[dir][v].bitsets_s[1], labels[dir][v].bitsets_s[1]);
+    }
+  }
+
+  std::array<std::vector<BitParallelLabels<std::uint8_t>>, 2> wrongWidth;
+  EXPECT_THROW(loadFromFile(wrongWidth, "test_load.txt"), std::runtime_error);
+  std::remove("test_load.txt");
+}
+
+TEST(LoadFromFileTest, MalformedFile) {
+  std::ofstream file("test_load.txt");
+  file << "V 2\no 0 0 0\ni 0 0\n";
+  file.close();
+
+  std::array<std::vector<Label>, 2> labels;
+  std::vector<Vertex> f, oldToNew;
+  std::vector<std::uint8_t> partition;
+  EXPECT_THROW(loadFromFile(labels, f, partition, oldToNew, "test_load.txt"),
+               std::runtime_error);
+  std::remove("test_load.txt");
 }
\ No newline at end of file
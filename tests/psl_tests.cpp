@@ -0,0 +1,318 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <queue>
+#include <vector>
+
+#include "../datastructures/psl.h"
+#include "../datastructures/psl_star.h"
+
+class PSLTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::srand(13);
+    std::vector<std::vector<Edge>> edges(1);
+    for (int i = 0; i < 1200; ++i) {
+      edges[0].emplace_back(std::rand() % 400, std::rand() % 400);
+    }
+    fwdGraph.buildFromEdges(edges, 400, 1, true);
+    bwdGraph = fwdGraph.reverseGraph();
+  }
+
+  std::vector<Distance> bfs(const Vertex source) const {
+    std::vector<Distance> dist(fwdGraph.numVertices(), infinity);
+    std::queue<Vertex> queue;
+    dist[source] = 0;
+    queue.push(source);
+    while (!queue.empty()) {
+      const Vertex u = queue.front();
+      queue.pop();
+      fwdGraph.relaxAllEdges(u, [&](Vertex, const Vertex v) {
+        if (dist[v] != infinity) return;
+        dist[v] = dist[u] + 1;
+        queue.push(v);
+      });
+    }
+    return dist;
+  }
+
+  Graph fwdGraph;
+  Graph bwdGraph;
+};
+
+TEST_F(PSLTest, QueriesMatchBFS) {
+  PSL psl(&fwdGraph, &bwdGraph, 4);
+  psl.run();
+
+  for (Vertex s = 0; s < fwdGraph.numVertices(); s += 7) {
+    const std::vector<Distance> expected = bfs(s);
+    for (Vertex t = 0; t < fwdGraph.numVertices(); ++t) {
+      ASSERT_EQ(query(psl.labels[FWD][s], psl.labels[BWD][t]), expected[t])
+          << s << " -> " << t;
+    }
+  }
+}
+
+TEST_F(PSLTest, IndependentOfThreads) {
+  PSL sequential(&fwdGraph, &bwdGraph, 1);
+  sequential.run();
+
+  ThreadPool pool(5);
+  PSL parallel(&fwdGraph, &bwdGraph, pool);
+  parallel.run();
+
+  for (const DIRECTION dir : {FWD, BWD}) {
+    for (Vertex v = 0; v < fwdGraph.numVertices(); ++v) {
+      EXPECT_EQ(parallel.labels[dir][v].hubs, sequential.labels[dir][v].hubs);
+      EXPECT_EQ(parallel.labels[dir][v].dists,
+                sequential.labels[dir][v].dists);
+    }
+  }
+}
+
+TEST_F(PSLTest, StarIndependentOfThreads) {
+  PSLStar sequential(&fwdGraph, &bwdGraph, 1);
+  sequential.run();
+
+  PSLStar parallel(&fwdGraph, &bwdGraph, 3);
+  parallel.run();
+
+  for (const DIRECTION dir : {FWD, BWD}) {
+    for (Vertex v = 0; v < fwdGraph.numVertices(); ++v) {
+      EXPECT_EQ(parallel.labels[dir][v].hubs, sequential.labels[dir][v].hubs);
+      EXPECT_EQ(parallel.labels[dir][v].dists,
+                sequential.labels[dir][v].dists);
+    }
+  }
+}
+
+TEST_F(PSLTest, DenseLookupMatchesMerge) {
+  PSL merge(&fwdGraph, &bwdGraph, 2);
+  merge.run();
+
+  PSL dense(&fwdGraph, &bwdGraph, 2);
+  dense.denseLookup = true;
+  dense.run();
+
+  PSLStar denseStar(&fwdGraph, &bwdGraph, 2);
+  denseStar.denseLookup = true;
+  denseStar.run();
+
+  PSLStar mergeStar(&fwdGraph, &bwdGraph, 2);
+  mergeStar.run();
+
+  for (const DIRECTION dir : {FWD, BWD}) {
+    for (Vertex v = 0; v < fwdGraph.numVertices(); ++v) {
+      EXPECT_EQ(dense.labels[dir][v].hubs, merge.labels[dir][v].hubs);
+      EXPECT_EQ(dense.labels[dir][v].dists, merge.labels[dir][v].dists);
+      EXPECT_EQ(denseStar.labels[dir][v].hubs, mergeStar.labels[dir][v].hubs);
+      EXPECT_EQ(denseStar.labels[dir][v].dists,
+                mergeStar.labels[dir][v].dists);
+    }
+  }
+}
+
+TEST_F(PSLTest, HashedCandidatesMatchTimestamps) {
+  PSL timestamps(&fwdGraph, &bwdGraph, 2);
+  timestamps.candidateMode = CandidateSet::Mode::TIMESTAMPS;
+  timestamps.run();
+
+  PSL hashed(&fwdGraph, &bwdGraph, 2);
+  hashed.candidateMode = CandidateSet::Mode::HASHED;
+  hashed.run();
+
+  PSLStar hashedStar(&fwdGraph, &bwdGraph, 2);
+  hashedStar.candidateMode = CandidateSet::Mode::HASHED;
+  hashedStar.run();
+
+  PSLStar timestampsStar(&fwdGraph, &bwdGraph, 2);
+  timestampsStar.candidateMode = CandidateSet::Mode::TIMESTAMPS;
+  timestampsStar.run();
+
+  for (const DIRECTION dir : {FWD, BWD}) {
+    for (Vertex v = 0; v < fwdGraph.numVertices(); ++v) {
+      EXPECT_EQ(hashed.labels[dir][v].hubs, timestamps.labels[dir][v].hubs);
+      EXPECT_EQ(hashed.labels[dir][v].dists, timestamps.labels[dir][v].dists);
+      EXPECT_EQ(hashedStar.labels[dir][v].hubs,
+                timestampsStar.labels[dir][v].hubs);
+      EXPECT_EQ(hashedStar.labels[dir][v].dists,
+                timestampsStar.labels[dir][v].dists);
+    }
+  }
+}
+
+TEST_F(PSLTest, PrunedSearchesMatchRounds) {
+  PSL rounds(&fwdGraph, &bwdGraph, 2);
+  rounds.run();
+
+  // switches right after the first round, and after a few rounds
+  for (const double tailYield : {1000.0, 1.0}) {
+    PSL tail(&fwdGraph, &bwdGraph, 3);
+    tail.tailYield = tailYield;
+    tail.run();
+    EXPECT_GT(tail.tailStats.numSearches, 0);
+
+    for (const DIRECTION dir : {FWD, BWD}) {
+      for (Vertex v = 0; v < fwdGraph.numVertices(); ++v) {
+        EXPECT_EQ(tail.labels[dir][v].hubs, rounds.labels[dir][v].hubs);
+        EXPECT_EQ(tail.labels[dir][v].dists, rounds.labels[dir][v].dists);
+      }
+    }
+  }
+}
+
+TEST_F(PSLTest, PushRoundsMatchPullRounds) {
+  PSL pull(&fwdGraph, &bwdGraph, 2);
+  pull.roundMode = ROUND_MODE::PULL;
+  pull.run();
+  EXPECT_EQ(pull.numPushRounds, 0);
+
+  PSLStar pullStar(&fwdGraph, &bwdGraph, 2);
+  pullStar.roundMode = ROUND_MODE::PULL;
+  pullStar.run();
+
+  for (const ROUND_MODE mode : {ROUND_MODE::PUSH, ROUND_MODE::AUTO}) {
+    for (const bool denseLookup : {false, true}) {
+      PSL psl(&fwdGraph, &bwdGraph, 3);
+      psl.roundMode = mode;
+      psl.denseLookup = denseLookup;
+      psl.run();
+
+      PSLStar star(&fwdGraph, &bwdGraph, 3);
+      star.roundMode = mode;
+      star.denseLookup = denseLookup;
+      star.run();
+
+      if (mode == ROUND_MODE::PUSH) {
+        EXPECT_GT(psl.numPushRounds, 0);
+        EXPECT_GT(star.numPushRounds, 0);
+      }
+
+      for (const DIRECTION dir : {FWD, BWD}) {
+        for (Vertex v = 0; v < fwdGraph.numVertices(); ++v) {
+          EXPECT_EQ(psl.labels[dir][v].hubs, pull.labels[dir][v].hubs);
+          EXPECT_EQ(psl.labels[dir][v].dists, pull.labels[dir][v].dists);
+          EXPECT_EQ(star.labels[dir][v].hubs, pullStar.labels[dir][v].hubs);
+          EXPECT_EQ(star.labels[dir][v].dists, pullStar.labels[dir][v].dists);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(PSLTest, BitParallelQueriesMatchBFS) {
+  PSL plain(&fwdGraph, &bwdGraph, 2);
+  plain.run();
+
+  for (const double tailYield : {0.0, 1.0}) {
+    for (const ROUND_MODE mode : {ROUND_MODE::PULL, ROUND_MODE::PUSH}) {
+      PSL psl(&fwdGraph, &bwdGraph, 3);
+      psl.numBitParallelRoots = 4;
+      psl.tailYield = tailYield;
+      psl.roundMode = mode;
+      psl.run();
+      ASSERT_EQ(psl.bitParallelLabels[FWD].numVertices(),
+                fwdGraph.numVertices());
+
+      std::size_t numEntries = 0, numPlainEntries = 0;
+      for (const DIRECTION dir : {FWD, BWD}) {
+        for (Vertex v = 0; v < fwdGraph.numVertices(); ++v) {
+          numEntries += psl.labels[dir][v].size();
+          numPlainEntries += plain.labels[dir][v].size();
+        }
+      }
+      EXPECT_LT(numEntries, numPlainEntries);
+
+      for (Vertex s = 0; s < fwdGraph.numVertices(); s += 7) {
+        const std::vector<Distance> expected = bfs(s);
+        for (Vertex t = 0; t < fwdGraph.numVertices(); ++t) {
+          ASSERT_EQ(query(psl.bitParallelLabels[FWD][s],
+                          psl.bitParallelLabels[BWD][t],
+                          psl.labels[FWD][s].view(), psl.labels[BWD][t].view()),
+                    expected[t])
+              << s << " -> " << t;
+        }
+      }
+    }
+  }
+}
+
+// A path whose distances exceed infinity: the bit-parallel labels must not
+// hold (wrapped) distances of infinity or more, and pairs closer than
+// infinity must still be answered exactly.
+TEST(PSLLongPathTest, BitParallelLabelsBeyondInfinity) {
+  const Vertex n = 300;
+  std::vector<std::vector<Edge>> edges(1);
+  for (Vertex v = 0; v + 1 < n; ++v) {
+    edges[0].emplace_back(v, v + 1);
+    edges[0].emplace_back(v + 1, v);
+  }
+  Graph fwdGraph;
+  fwdGraph.buildFromEdges(edges, n, 1, true);
+  Graph bwdGraph = fwdGraph.reverseGraph();
+
+  auto expected = [](const Vertex s, const Vertex t) {
+    const Vertex hops = (s < t) ? t - s : s - t;
+    return hops < infinity ? static_cast<Distance>(hops) : infinity;
+  };
+
+  PSL psl(&fwdGraph, &bwdGraph, 2);
+  psl.numBitParallelRoots = 4;
+  psl.run();
+
+  for (const DIRECTION dir : {FWD, BWD}) {
+    for (Vertex v = 0; v < n; ++v) {
+      const auto& table = psl.bitParallelLabels[dir];
+      for (std::size_t i = 0; i < table.numRoots(); ++i) {
+        ASSERT_EQ(table[v].dists[i], expected(table.roots[i], v))
+            << table.roots[i] << " - " << v;
+      }
+    }
+  }
+
+  for (Vertex s = 0; s < n; s += 3) {
+    for (Vertex t = 0; t < n; ++t) {
+      ASSERT_EQ(query(psl.bitParallelLabels[FWD][s],
+                      psl.bitParallelLabels[BWD][t],
+                      psl.labels[FWD][s].view(), psl.labels[BWD][t].view()),
+                expected(s, t))
+          << s << " -> " << t;
+    }
+  }
+}
+
+// On a path longer than infinity, the rounds and the pruned searches for the
+// tail must not store (wrapped) distances of infinity or more.
+TEST(PSLLongPathTest, TailSearchesStopBeforeInfinity) {
+  const Vertex n = 300;
+  std::vector<std::vector<Edge>> edges(1);
+  for (Vertex v = 0; v + 1 < n; ++v) {
+    edges[0].emplace_back(v, v + 1);
+    edges[0].emplace_back(v + 1, v);
+  }
+  Graph fwdGraph;
+  fwdGraph.buildFromEdges(edges, n, 1, true);
+  Graph bwdGraph = fwdGraph.reverseGraph();
+
+  for (const double tailYield : {0.0, 1.0, 1000.0}) {
+    PSL psl(&fwdGraph, &bwdGraph, 3);
+    psl.tailYield = tailYield;
+    psl.run();
+
+    for (const DIRECTION dir : {FWD, BWD}) {
+      for (Vertex v = 0; v < n; ++v) {
+        psl.labels[dir][v].view().doForAll([&](Vertex hub, Distance dist) {
+          ASSERT_LT(dist, infinity) << tailYield << ": " << hub << " - " << v;
+        });
+      }
+    }
+    for (Vertex s = 0; s < n; s += 3) {
+      for (Vertex t = 0; t < n; ++t) {
+        const Vertex hops = (s < t) ? t - s : s - t;
+        ASSERT_EQ(query(psl.labels[FWD][s], psl.labels[BWD][t]),
+                  hops < infinity ? hops : infinity)
+            << tailYield << ": " << s << " -> " << t;
+      }
+    }
+  }
+}
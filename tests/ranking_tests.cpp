@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../datastructures/ranking.h"
+
+class RankingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // vertex 2 is the center of a star, vertex 4 only has in-edges
+    graph.buildFromEdges({{Edge(0, 2), Edge(1, 2), Edge(2, 3), Edge(2, 4),
+                           Edge(3, 4), Edge(0, 4), Edge(1, 4), Edge(2, 0)}},
+                         5);
+  }
+
+  void TearDown() override { std::remove("test_rank.txt"); }
+
+  Graph graph;
+};
+
+TEST_F(RankingTest, Degree) {
+  const std::vector<std::size_t> rank = degreeRank(graph);
+
+  EXPECT_TRUE(graph.rankIsPermutation(rank));
+  EXPECT_EQ(rank[2], 0);
+  EXPECT_EQ(rank[4], 1);
+}
+
+TEST_F(RankingTest, DegreeProduct) {
+  const std::vector<std::size_t> rank = degreeProductRank(graph);
+
+  // vertex 4 has the second highest degree, but no out-edges
+  EXPECT_TRUE(graph.rankIsPermutation(rank));
+  EXPECT_EQ(rank[2], 0);
+  EXPECT_EQ(rank[0], 1);
+}
+
+TEST_F(RankingTest, PathCoverage) {
+  const std::vector<std::size_t> rank = pathCoverageRank(graph, 2, 5);
+
+  EXPECT_TRUE(graph.rankIsPermutation(rank));
+  EXPECT_EQ(rank[2], 0);
+}
+
+TEST_F(RankingTest, IndependentOfThreads) {
+  std::srand(5);
+  std::vector<std::vector<Edge>> edges(1);
+  for (int i = 0; i < 3000; ++i) {
+    edges[0].emplace_back(std::rand() % 500, std::rand() % 500);
+  }
+  Graph large;
+  large.buildFromEdges(edges, 500);
+
+  EXPECT_EQ(degreeRank(large, 1), degreeRank(large, 3));
+  EXPECT_EQ(degreeProductRank(large, 1), degreeProductRank(large, 4));
+  EXPECT_EQ(pathCoverageRank(large, 1), pathCoverageRank(large, 3));
+  // more threads than trees
+  EXPECT_EQ(pathCoverageRank(large, 1, 2), pathCoverageRank(large, 9, 2));
+}
+
+TEST_F(RankingTest, RankFile) {
+  std::ofstream("test_rank.txt") << "3\n1\n\n5\n2\n4\n";
+
+  const std::vector<std::size_t> rank = readRankFile("test_rank.txt", 5);
+  EXPECT_EQ(rank, (std::vector<std::size_t>{1, 3, 0, 4, 2}));
+  EXPECT_EQ(computeRank(graph, parseOrdering("file"), 1, "test_rank.txt"),
+            rank);
+}
+
+TEST_F(RankingTest, InvalidRankFile) {
+  std::ofstream("test_rank.txt") << "3\n1\n3\n5\n2\n";
+  EXPECT_THROW(readRankFile("test_rank.txt", 5), std::runtime_error);
+
+  std::ofstream("test_rank.txt") << "3\n1\n5\n2\n";
+  EXPECT_THROW(readRankFile("test_rank.txt", 5), std::runtime_error);
+
+  EXPECT_THROW(parseOrdering("alphabetical"), std::runtime_error);
+}
\ No newline at end of file
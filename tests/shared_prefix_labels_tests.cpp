@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "../datastructures/shared_prefix_labels.h"
+
+class SharedPrefixLabelsTest : public ::testing::Test {
+ protected:
+  // labels which start with one of three hub sequences of different lengths
+  // (with their own distances) and continue with random hubs
+  void SetUp() override {
+    std::mt19937 randomGenerator(7);
+    labels = {std::vector<Label>(50), std::vector<Label>(50)};
+    for (const DIRECTION dir : {FWD, BWD}) {
+      for (std::size_t v = 0; v < labels[dir].size(); ++v) {
+        const std::size_t prefixSize = std::vector<std::size_t>{0, 5, 9}[v % 3];
+        Vertex hub = 0;
+        for (std::size_t i = 0; i < prefixSize; ++i, hub += 2) {
+          labels[dir][v].add(hub, randomGenerator() % 10);
+        }
+        for (std::size_t i = 0; i < v % 20; ++i) {
+          hub += 1 + randomGenerator() % 6;
+          labels[dir][v].add(hub, randomGenerator() % 10);
+        }
+      }
+    }
+  }
+
+  std::array<std::vector<Label>, 2> labels;
+};
+
+TEST_F(SharedPrefixLabelsTest, SplitsLabelsIntoPrefixAndTail) {
+  const auto shared = sharePrefixes(labels, 3);
+
+  for (const DIRECTION dir : {FWD, BWD}) {
+    ASSERT_EQ(shared[dir].numVertices(), labels[dir].size());
+    EXPECT_GT(shared[dir].numPrefixes(), 0);
+    EXPECT_LT(shared[dir].prefixHubs.size() + shared[dir].tailHubs.size(),
+              shared[dir].dists.size());
+
+    for (Vertex v = 0; v < labels[dir].size(); ++v) {
+      std::vector<Vertex> hubs;
+      std::vector<Distance> dists;
+      for (const LabelView view :
+           {shared[dir].prefixOf(v), shared[dir].tailOf(v)}) {
+        view.doForAll([&](Vertex hub, Distance dist) {
+          hubs.push_back(hub);
+          dists.push_back(dist);
+        });
+      }
+      EXPECT_EQ(shared[dir].size(v), labels[dir][v].size());
+      EXPECT_EQ(hubs, labels[dir][v].hubs);
+      EXPECT_EQ(dists, labels[dir][v].dists);
+    }
+  }
+}
+
+TEST_F(SharedPrefixLabelsTest, QueryMatchesLabelQuery) {
+  const auto shared = sharePrefixes(labels, 2);
+
+  for (Vertex v = 0; v < labels[FWD].size(); ++v) {
+    for (Vertex w = 0; w < labels[BWD].size(); ++w) {
+      EXPECT_EQ(query(shared, v, w), query(labels[FWD][v], labels[BWD][w]))
+          << v << " -> " << w;
+    }
+  }
+}
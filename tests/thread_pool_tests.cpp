@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "../datastructures/thread_pool.h"
+#include "../datastructures/utils.h"
+
+TEST(ThreadPoolTest, RunCallsEveryThreadOnce) {
+  ThreadPool pool(4);
+  ASSERT_EQ(pool.size(), 4);
+
+  std::vector<int> calls(pool.size(), 0);
+  pool.run([&](const std::size_t t) { calls[t]++; });
+
+  EXPECT_EQ(calls, std::vector<int>(4, 1));
+}
+
+TEST(ThreadPoolTest, ZeroThreadsMeansOne) {
+  ThreadPool pool(0);
+  EXPECT_EQ(pool.size(), 1);
+
+  int calls = 0;
+  pool.run([&](const std::size_t t) {
+    EXPECT_EQ(t, 0);
+    calls++;
+  });
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ThreadPoolTest, ForBlocksCoversRange) {
+  ThreadPool pool(3);
+  std::vector<int> visited(100, 0);
+
+  pool.forBlocks(10, 100,
+                 [&](std::size_t, const std::size_t begin,
+                     const std::size_t end) {
+                   for (std::size_t i = begin; i < end; ++i) visited[i]++;
+                 });
+
+  for (std::size_t i = 0; i < visited.size(); ++i) {
+    EXPECT_EQ(visited[i], i < 10 ? 0 : 1);
+  }
+}
+
+TEST(ThreadPoolTest, ReusedForManyRounds) {
+  ThreadPool pool(4);
+  std::vector<std::atomic<int>> processed(37);
+
+  // every call ends with a barrier, so each round sees the previous one
+  for (int round = 0; round < 200; ++round) {
+    pool.forTasks(processed.size(), [&](std::size_t, const std::size_t task) {
+      EXPECT_EQ(processed[task].load(), round);
+      processed[task]++;
+    });
+  }
+
+  for (const auto &count : processed) EXPECT_EQ(count.load(), 200);
+}
+
+TEST(ThreadPoolTest, TracksBusyTime) {
+  ThreadPool pool(2);
+  pool.run([](std::size_t) {
+    const long long start = get_micro_time();
+    while (get_micro_time() - start < 2000) {
+    }
+  });
+
+  ASSERT_EQ(pool.busyTime().size(), 2);
+  for (const long long time : pool.busyTime()) EXPECT_GE(time, 2000);
+
+  pool.resetBusyTime();
+  EXPECT_EQ(pool.busyTime(), std::vector<long long>(2, 0));
+}
+
+TEST(BalancedChunksTest, SplitsByWeight) {
+  // the first item weighs as much as all others together
+  const std::vector<std::size_t> weights = {8, 1, 1, 1, 1, 1, 1, 1, 1};
+  const std::vector<std::size_t> boundaries = balancedChunks(
+      weights.size(), 4, [&](const std::size_t i) { return weights[i]; });
+
+  EXPECT_EQ(boundaries, (std::vector<std::size_t>{0, 1, 5, 9}));
+}
+
+TEST(BalancedChunksTest, UniformWeights) {
+  const std::vector<std::size_t> boundaries =
+      balancedChunks(10, 5, [](std::size_t) { return 1; });
+  EXPECT_EQ(boundaries, (std::vector<std::size_t>{0, 2, 4, 6, 8, 10}));
+
+  EXPECT_EQ(balancedChunks(0, 5, [](std::size_t) { return 1; }),
+            (std::vector<std::size_t>{0, 0}));
+}
\ No newline at end of file
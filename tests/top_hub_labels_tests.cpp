@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "../datastructures/top_hub_labels.h"
+
+class TopHubLabelsTest : public ::testing::Test {
+ protected:
+  // random sorted labels whose hubs are dense among the small ids and sparse
+  // above them
+  void SetUp() override {
+    std::mt19937 randomGenerator(13);
+    labels = {std::vector<Label>(50), std::vector<Label>(50)};
+    for (const DIRECTION dir : {FWD, BWD}) {
+      for (std::size_t v = 0; v < labels[dir].size(); ++v) {
+        Vertex hub = randomGenerator() % 3;
+        for (std::size_t i = 0; i < v * 3; ++i) {
+          labels[dir][v].add(hub, randomGenerator() % (infinity + 1));
+          hub += 1 + randomGenerator() % (hub < 150 ? 3 : 20);
+        }
+      }
+    }
+  }
+
+  std::array<std::vector<Label>, 2> labels;
+};
+
+TEST_F(TopHubLabelsTest, SplitsLabelsAtTopHubs) {
+  const auto topHubLabels = splitTopHubs(labels, 100, 3);
+  EXPECT_EQ(topHubLabels[FWD].rowWidth, 128);
+
+  for (const DIRECTION dir : {FWD, BWD}) {
+    ASSERT_EQ(topHubLabels[dir].numVertices(), labels[dir].size());
+    for (Vertex v = 0; v < labels[dir].size(); ++v) {
+      const Distance* row = topHubLabels[dir].rowOf(v);
+      std::vector<Distance> expectedRow(128, infinity);
+      std::vector<Vertex> tailHubs;
+      labels[dir][v].doForAll([&](Vertex hub, Distance dist) {
+        if (hub < 100)
+          expectedRow[hub] = dist;
+        else
+          tailHubs.push_back(hub);
+      });
+      EXPECT_EQ(std::vector<Distance>(row, row + 128), expectedRow);
+
+      const LabelView tail = topHubLabels[dir].tailOf(v);
+      EXPECT_EQ(std::vector<Vertex>(tail.hubs, tail.hubs + tail.size),
+                tailHubs);
+    }
+  }
+}
+
+TEST_F(TopHubLabelsTest, QueryMatchesLabelQuery) {
+  for (const std::size_t numTopHubs : {0, 1, 64, 200, 5000}) {
+    const auto topHubLabels = splitTopHubs(labels, numTopHubs, 2);
+    for (Vertex v = 0; v < labels[FWD].size(); ++v) {
+      for (Vertex w = 0; w < labels[BWD].size(); ++w) {
+        EXPECT_EQ(query(topHubLabels, v, w),
+                  query(labels[FWD][v], labels[BWD][w]))
+            << numTopHubs << ": " << v << " -> " << w;
+      }
+    }
+  }
+}
+
+TEST(MinDistanceDenseTest, FindsMinimumInEveryLane) {
+  std::mt19937 randomGenerator(17);
+  std::vector<Distance> left(128, infinity), right(128, infinity);
+  EXPECT_EQ(minDistanceDense(left.data(), right.data(), 128), infinity);
+
+  for (std::size_t lane = 0; lane < 128; ++lane) {
+    for (std::size_t i = 0; i < 128; ++i) {
+      left[i] = 20 + randomGenerator() % (infinity - 19);
+      right[i] = 20 + randomGenerator() % (infinity - 19);
+    }
+    left[lane] = 3;
+    right[lane] = 5;
+    EXPECT_EQ(minDistanceDense(left.data(), right.data(), 128), 8) << lane;
+  }
+}